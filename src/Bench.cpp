@@ -0,0 +1,423 @@
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include "Bench.h"
+#include "Simulator.h"
+
+using std::chrono::duration;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::exception;
+using std::istream;
+using std::map;
+using std::nullopt;
+using std::optional;
+using std::ostream;
+using std::string;
+using std::vector;
+
+using nlohmann::json;
+
+namespace gossip {
+namespace simulator {
+
+namespace {
+
+// Once all nodes hold the payload, gossip only exchanges duplicates, which
+// must not allocate at all.
+constexpr int steadyStateRounds{ 10 };
+
+Scenario makeScenario(string name,
+                      int numNodes,
+                      int numNeighbors,
+                      int fanout,
+                      unsigned seed,
+                      int payloadBytes = 0)
+{
+    Opts opts;
+    opts.numNodes = numNodes;
+    opts.numNeighbors = numNeighbors;
+    opts.period = milliseconds(10);
+    opts.fanout = fanout;
+    opts.numZones = 1;
+    opts.zoneWeight = 1;
+    opts.joinRate = 0;
+    opts.leaveRate = 0;
+    opts.crashRate = 0;
+    opts.stallRounds = 0;
+    opts.numWorkers = 1;
+    opts.payloadBytes = payloadBytes;
+    opts.analyze = false;
+    opts.outfile = "/dev/null";
+    opts.seed = seed;
+    opts.inject = 1;
+
+    return { std::move(name), std::move(opts) };
+}
+
+double toMs(microseconds us)
+{
+    return duration<double, std::milli>(us).count();
+}
+
+json toJson(const vector<Profiler::Phase>& phases)
+{
+    json result = json::array();
+
+    for (const auto& phase : phases) {
+        result.push_back({
+            { "name", phase.name },
+            { "wallUs", phase.wallTime.count() },
+            { "cpuUs", phase.cpuTime.count() },
+            { "rssGrowthKb", phase.rssGrowthKb },
+            { "events", phase.numEvents },
+            { "allocations", phase.numAllocations }
+        });
+    }
+
+    return result;
+}
+
+vector<Profiler::Phase> fromJson(const json& phases)
+{
+    vector<Profiler::Phase> result;
+
+    for (const auto& entry : phases) {
+        Profiler::Phase phase;
+        phase.name = entry.at("name").get<string>();
+        phase.wallTime = microseconds(entry.at("wallUs").get<int64_t>());
+        phase.cpuTime = microseconds(entry.at("cpuUs").get<int64_t>());
+        phase.rssGrowthKb = entry.value("rssGrowthKb", 0L);
+        phase.numEvents = entry.at("events").get<uint64_t>();
+        phase.numAllocations = entry.value("allocations", uint64_t{ 0 });
+        result.push_back(std::move(phase));
+    }
+
+    return result;
+}
+
+// Runs the scenario in a child process, so each run starts with a fresh
+// address space (peak RSS is per process) and its own set of ports.
+[[noreturn]] void runChild(const Scenario& scenario, seconds timeout, int fd)
+{
+    alarm(timeout.count());
+    std::cout.rdbuf(nullptr);
+
+    string out;
+
+    try {
+        Simulator simulator(scenario.opts);
+        {
+            vector<NodeResult> nodes = simulator.run();
+            simulator.runSteadyState(steadyStateRounds);
+
+            Profiler& profiler = simulator.profiler();
+            uint64_t numAllocations = profiler.phases().back().numAllocations;
+            if (numAllocations > 0) {
+                std::cerr << scenario.name << ": " << numAllocations <<
+                    " allocations in steady state" << std::endl;
+                _exit(1);
+            }
+
+            profiler.measure("export", [&simulator, &nodes, &scenario] {
+                printStats(nodes, simulator.departed(), scenario.opts.outfile);
+            });
+            profiler.addEvents(nodes.size());
+        }
+
+        out = toJson(simulator.profiler().phases()).dump();
+    } catch (const exception& e) {
+        std::cerr << scenario.name << ": " << e.what() << std::endl;
+        _exit(1);
+    }
+
+    for (size_t pos = 0; pos < out.size(); ) {
+        ssize_t num = write(fd, out.data() + pos, out.size() - pos);
+        if (num < 0 && errno != EINTR) {
+            _exit(1);
+        }
+        pos += std::max<ssize_t>(num, 0);
+    }
+
+    _exit(0);
+}
+
+optional<vector<Profiler::Phase>> runOnce(const Scenario& scenario, seconds timeout)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::cerr << "pipe: " << std::strerror(errno) << std::endl;
+        return nullopt;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "fork: " << std::strerror(errno) << std::endl;
+        close(fds[0]);
+        close(fds[1]);
+        return nullopt;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        runChild(scenario, timeout, fds[1]);
+    }
+
+    close(fds[1]);
+
+    string in;
+    char buf[4096];
+    for (;;) {
+        ssize_t num = read(fds[0], buf, sizeof(buf));
+        if (num < 0 && errno == EINTR) {
+            continue;
+        }
+        if (num <= 0) {
+            break;
+        }
+        in.append(buf, num);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << scenario.name << ": run failed" <<
+            (WIFSIGNALED(status) ? " (timeout or signal)" : "") << std::endl;
+        return nullopt;
+    }
+
+    try {
+        return fromJson(json::parse(in));
+    } catch (const exception& e) {
+        std::cerr << scenario.name << ": " << e.what() << std::endl;
+        return nullopt;
+    }
+}
+
+// Keeps the best value of each metric, which filters out most of the noise
+// caused by other processes competing for the machine.
+void mergeBest(vector<Profiler::Phase>& best, const vector<Profiler::Phase>& phases)
+{
+    if (best.empty()) {
+        best = phases;
+        return;
+    }
+
+    for (size_t i = 0; i < std::min(best.size(), phases.size()); ++i) {
+        best[i].wallTime = std::min(best[i].wallTime, phases[i].wallTime);
+        best[i].cpuTime = std::min(best[i].cpuTime, phases[i].cpuTime);
+        best[i].rssGrowthKb = std::min(best[i].rssGrowthKb, phases[i].rssGrowthKb);
+        best[i].numEvents = std::min(best[i].numEvents, phases[i].numEvents);
+        best[i].numAllocations = std::min(best[i].numAllocations, phases[i].numAllocations);
+    }
+}
+
+const Profiler::Phase* findPhase(const vector<Profiler::Phase>& phases, const string& name)
+{
+    auto pos = std::find_if(phases.begin(), phases.end(), [&name](const auto& phase) {
+        return phase.name == name;
+    });
+
+    return pos != phases.end() ? &*pos : nullptr;
+}
+
+string describe(const string& what, double base, double cur, const char* unit)
+{
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(1) << what << ": " << base << unit <<
+        " -> " << cur << unit;
+
+    // Growth from zero has no meaningful percentage, e.g. for RSS growth.
+    if (base > 0) {
+        s << " (+" << (cur / base - 1) * 100 << "%)";
+    } else {
+        s << " (+" << cur - base << unit << ")";
+    }
+    return s.str();
+}
+
+} // namespace
+
+vector<Scenario> goldenScenarios()
+{
+    return {
+        makeScenario("small", 10, 3, 1, 1),
+        makeScenario("medium", 100, 6, 2, 2),
+        makeScenario("large", 500, 8, 2, 3),
+        makeScenario("high-fanout", 200, 30, 10, 4),
+        makeScenario("large-payload", 50, 6, 2, 5, 64 * 1024)
+    };
+}
+
+optional<vector<Profiler::Phase>> runScenario(const Scenario& scenario,
+                                              int repeat,
+                                              seconds timeout)
+{
+    vector<Profiler::Phase> best;
+
+    for (int i = 0; i < repeat; ++i) {
+        optional<vector<Profiler::Phase>> phases = runOnce(scenario, timeout);
+        if (!phases) {
+            return nullopt;
+        }
+
+        mergeBest(best, *phases);
+    }
+
+    return best;
+}
+
+vector<string> findMissing(const Results& baseline, const Results& current)
+{
+    vector<string> missing;
+
+    for (const auto& [scenario, phases] : current) {
+        auto pos = baseline.find(scenario);
+        if (pos == baseline.end()) {
+            missing.push_back(scenario);
+            continue;
+        }
+
+        for (const auto& phase : phases) {
+            if (!findPhase(pos->second, phase.name)) {
+                missing.push_back(scenario + "/" + phase.name);
+            }
+        }
+    }
+
+    return missing;
+}
+
+vector<string> findRegressions(const Results& baseline,
+                               const Results& current,
+                               const Thresholds& thresholds)
+{
+    vector<string> regressions;
+
+    auto exceeds = [](double base, double cur, double maxRegression) {
+        return cur > base * (1 + maxRegression / 100);
+    };
+
+    for (const auto& [scenario, phases] : current) {
+        auto pos = baseline.find(scenario);
+        if (pos == baseline.end()) {
+            continue;
+        }
+
+        for (const auto& phase : phases) {
+            const Profiler::Phase* base = findPhase(pos->second, phase.name);
+            if (!base) {
+                continue;
+            }
+
+            string prefix = scenario + "/" + phase.name;
+
+            if (phase.wallTime - base->wallTime > thresholds.minTimeDelta &&
+                exceeds(base->wallTime.count(),
+                        phase.wallTime.count(),
+                        thresholds.maxTimeRegression)) {
+                regressions.push_back(describe(prefix + " wall time",
+                                               toMs(base->wallTime),
+                                               toMs(phase.wallTime),
+                                               "ms"));
+            }
+
+            if (phase.cpuTime - base->cpuTime > thresholds.minTimeDelta &&
+                exceeds(base->cpuTime.count(),
+                        phase.cpuTime.count(),
+                        thresholds.maxTimeRegression)) {
+                regressions.push_back(describe(prefix + " cpu time",
+                                               toMs(base->cpuTime),
+                                               toMs(phase.cpuTime),
+                                               "ms"));
+            }
+
+            if (phase.rssGrowthKb - base->rssGrowthKb > thresholds.minRssDeltaKb &&
+                exceeds(base->rssGrowthKb, phase.rssGrowthKb, thresholds.maxRssRegression)) {
+                regressions.push_back(describe(prefix + " RSS growth",
+                                               base->rssGrowthKb,
+                                               phase.rssGrowthKb,
+                                               "KB"));
+            }
+
+            if (phase.numAllocations > base->numAllocations + thresholds.minAllocDelta &&
+                exceeds(base->numAllocations,
+                        phase.numAllocations,
+                        thresholds.maxAllocRegression)) {
+                regressions.push_back(describe(prefix + " allocations",
+                                               base->numAllocations,
+                                               phase.numAllocations,
+                                               ""));
+            }
+        }
+    }
+
+    return regressions;
+}
+
+void printResults(const Results& results, ostream& out)
+{
+    out << std::left << std::setw(14) << "scenario" << std::setw(15) << "phase" <<
+        std::right << std::setw(12) << "wall[ms]" << std::setw(12) << "cpu[ms]" <<
+        std::setw(12) << "+rss[KB]" << std::setw(12) << "events" <<
+        std::setw(12) << "allocs" << std::endl;
+
+    out << std::fixed << std::setprecision(2);
+
+    for (const auto& [scenario, phases] : results) {
+        for (const auto& phase : phases) {
+            out << std::left << std::setw(14) << scenario <<
+                std::setw(15) << phase.name << std::right <<
+                std::setw(12) << toMs(phase.wallTime) <<
+                std::setw(12) << toMs(phase.cpuTime) <<
+                std::setw(12) << phase.rssGrowthKb <<
+                std::setw(12) << phase.numEvents <<
+                std::setw(12) << phase.numAllocations << std::endl;
+        }
+    }
+}
+
+void writeResults(const Results& results, ostream& out)
+{
+    json scenarios = json::object();
+
+    for (const auto& [scenario, phases] : results) {
+        scenarios[scenario] = toJson(phases);
+    }
+
+    out << json{ { "scenarios", std::move(scenarios) } }.dump(2) << std::endl;
+}
+
+optional<Results> readResults(istream& in)
+{
+    try {
+        json doc = json::parse(in);
+
+        Results results;
+        for (const auto& [scenario, phases] : doc.at("scenarios").items()) {
+            results.emplace(scenario, fromJson(phases));
+        }
+
+        return results;
+    } catch (const exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return nullopt;
+    }
+}
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Opts.h"
+#include "Profiler.h"
+
+namespace gossip {
+namespace simulator {
+
+struct Scenario {
+    std::string name;
+    Opts opts;
+};
+
+struct Thresholds {
+    double maxTimeRegression;
+    double maxRssRegression;
+    double maxAllocRegression;
+    std::chrono::microseconds minTimeDelta;
+    long minRssDeltaKb;
+    uint64_t minAllocDelta;
+};
+
+using Results = std::map<std::string, std::vector<Profiler::Phase>>;
+
+std::vector<Scenario> goldenScenarios();
+
+std::optional<std::vector<Profiler::Phase>> runScenario(const Scenario& scenario,
+                                                        int repeat,
+                                                        std::chrono::seconds timeout);
+
+// Returns the scenarios and phases of current which the baseline lacks, so
+// they can't be compared.
+std::vector<std::string> findMissing(const Results& baseline, const Results& current);
+
+std::vector<std::string> findRegressions(const Results& baseline,
+                                         const Results& current,
+                                         const Thresholds& thresholds);
+
+void printResults(const Results& results, std::ostream& out);
+void writeResults(const Results& results, std::ostream& out);
+std::optional<Results> readResults(std::istream& in);
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "Bench.h"
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::exception;
+using std::ifstream;
+using std::ofstream;
+using std::optional;
+using std::string;
+using std::vector;
+
+using gossip::simulator::Profiler;
+using gossip::simulator::Results;
+using gossip::simulator::Scenario;
+using gossip::simulator::Thresholds;
+
+namespace po = boost::program_options;
+
+// Counts heap allocations for the profiler's phases. The array and nothrow
+// forms call these.
+void* operator new(size_t size)
+{
+    Profiler::allocations().fetch_add(1, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+int main(int argc, char* argv[])
+{
+    vector<string> names;
+    int repeat;
+    int timeoutSec;
+    string baselinePath;
+    string outPath;
+    double maxTimeRegression;
+    double maxRssRegression;
+    double maxAllocRegression;
+    int minTimeDeltaMs;
+    long minRssDeltaKb;
+    int minAllocDelta;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("scenario",
+         po::value<vector<string>>(&names)->multitoken(),
+         "scenarios to run (default: all)")
+        ("repeat", po::value<int>(&repeat)->default_value(3), "runs per scenario, best is kept")
+        ("timeout-sec",
+         po::value<int>(&timeoutSec)->default_value(60),
+         "abort a single run after this time")
+        ("baseline", po::value<string>(&baselinePath), "path to read the baseline from")
+        ("write-baseline", po::value<string>(&outPath), "path to write results as baseline")
+        ("max-time-regression",
+         po::value<double>(&maxTimeRegression)->default_value(25),
+         "allowed wall and cpu time increase per phase in percent")
+        ("max-rss-regression",
+         po::value<double>(&maxRssRegression)->default_value(25),
+         "allowed increase of RSS growth per phase in percent")
+        ("max-alloc-regression",
+         po::value<double>(&maxAllocRegression)->default_value(25),
+         "allowed increase of heap allocations per phase in percent")
+        ("min-time-delta-ms",
+         po::value<int>(&minTimeDeltaMs)->default_value(10),
+         "time increases below this are never reported")
+        ("min-rss-delta-kb",
+         po::value<long>(&minRssDeltaKb)->default_value(1024),
+         "RSS growth increases up to this are never reported")
+        ("min-alloc-delta",
+         po::value<int>(&minAllocDelta)->default_value(16),
+         "allocation increases up to this are never reported");
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cerr << desc << std::endl;
+            return 2;
+        }
+
+        po::notify(vm);
+    } catch (const exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return 2;
+    }
+
+    if (repeat <= 0 || timeoutSec <= 0) {
+        std::cerr << "Repeat and timeout must be positive" << std::endl;
+        return 2;
+    }
+
+    if (minRssDeltaKb < 0 || minAllocDelta < 0) {
+        std::cerr << "Min. RSS and allocation deltas must not be negative" << std::endl;
+        return 2;
+    }
+
+    optional<Results> baseline;
+    if (!baselinePath.empty()) {
+        ifstream in(baselinePath);
+        if (!in) {
+            std::cerr << "Can't read baseline from " << baselinePath << std::endl;
+            return 2;
+        }
+
+        baseline = gossip::simulator::readResults(in);
+        if (!baseline) {
+            return 2;
+        }
+    }
+
+    Results results;
+    bool failed = false;
+
+    for (const Scenario& scenario : gossip::simulator::goldenScenarios()) {
+        if (!names.empty() &&
+            std::find(names.begin(), names.end(), scenario.name) == names.end()) {
+            continue;
+        }
+
+        std::cerr << "Running " << scenario.name << "..." << std::endl;
+
+        optional<vector<Profiler::Phase>> phases =
+            gossip::simulator::runScenario(scenario, repeat, seconds(timeoutSec));
+        if (!phases) {
+            failed = true;
+            continue;
+        }
+
+        results.emplace(scenario.name, std::move(*phases));
+    }
+
+    gossip::simulator::printResults(results, std::cout);
+
+    if (!outPath.empty()) {
+        ofstream out(outPath);
+        gossip::simulator::writeResults(results, out);
+        std::cout << "Wrote baseline to " << outPath << std::endl;
+    }
+
+    if (baseline) {
+        Thresholds thresholds{
+            maxTimeRegression,
+            maxRssRegression,
+            maxAllocRegression,
+            milliseconds(minTimeDeltaMs),
+            minRssDeltaKb,
+            static_cast<uint64_t>(minAllocDelta)
+        };
+
+        vector<string> regressions =
+            gossip::simulator::findRegressions(*baseline, results, thresholds);
+
+        std::cout << "---" << std::endl;
+        for (const string& missing : gossip::simulator::findMissing(*baseline, results)) {
+            std::cout << "Warning: no baseline for " << missing << std::endl;
+        }
+        for (const string& regression : regressions) {
+            std::cout << "Regression: " << regression << std::endl;
+        }
+
+        if (regressions.empty()) {
+            std::cout << "No regressions against " << baselinePath << std::endl;
+        }
+
+        failed = failed || !regressions.empty();
+    }
+
+    return failed ? 1 : 0;
+}
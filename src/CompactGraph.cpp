@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <numeric>
+
+#include "CompactGraph.h"
+#include "Graph.h"
+
+using std::vector;
+
+namespace gossip {
+namespace simulator {
+
+CompactGraph::CompactGraph(const Graph& g)
+{
+    for (int vertex : g.vertices()) {
+        vertices_.push_back(vertex);
+    }
+
+    offsets_.reserve(vertices_.size() + 1);
+    offsets_.push_back(0);
+
+    for (int vertex : vertices_) {
+        for (int adjacent : g.adjacents(vertex)) {
+            adjacents_.push_back(index(adjacent));
+        }
+        offsets_.push_back(adjacents_.size());
+    }
+}
+
+CompactGraph CompactGraph::transpose() const
+{
+    CompactGraph t;
+    t.vertices_ = vertices_;
+    t.offsets_.assign(offsets_.size(), 0);
+    t.adjacents_.resize(adjacents_.size());
+
+    for (int adjacent : adjacents_) {
+        ++t.offsets_[adjacent + 1];
+    }
+    std::partial_sum(t.offsets_.begin(), t.offsets_.end(), t.offsets_.begin());
+
+    vector<int> next(t.offsets_.begin(), t.offsets_.end() - 1);
+    for (int index = 0; index < numVertices(); ++index) {
+        for (int i = offsets_[index]; i < offsets_[index + 1]; ++i) {
+            t.adjacents_[next[adjacents_[i]]++] = index;
+        }
+    }
+
+    return t;
+}
+
+int CompactGraph::numVertices() const
+{
+    return vertices_.size();
+}
+
+int CompactGraph::numEdges() const
+{
+    return adjacents_.size();
+}
+
+int CompactGraph::index(int vertex) const
+{
+    return std::lower_bound(vertices_.begin(), vertices_.end(), vertex) - vertices_.begin();
+}
+
+int CompactGraph::vertex(int index) const
+{
+    return vertices_[index];
+}
+
+int CompactGraph::degree(int index) const
+{
+    return offsets_[index + 1] - offsets_[index];
+}
+
+const int* CompactGraph::adjacents(int index) const
+{
+    return adjacents_.data() + offsets_[index];
+}
+
+} // namespace simulator
+} // namespace gossip
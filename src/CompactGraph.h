@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+namespace gossip {
+namespace simulator {
+
+class Graph;
+
+// Read-only copy of a Graph in compressed sparse row layout, with vertices
+// renumbered to 0..n-1. Meant for algorithms sweeping the graph many times.
+class CompactGraph final {
+public:
+    explicit CompactGraph(const Graph& g);
+
+    // Returns the graph with all edges reversed, so adjacents() are the
+    // predecessors of a vertex.
+    CompactGraph transpose() const;
+
+    int numVertices() const;
+    int numEdges() const;
+
+    int index(int vertex) const;
+    int vertex(int index) const;
+
+    int degree(int index) const;
+    const int* adjacents(int index) const;
+
+private:
+    CompactGraph() = default;
+
+    std::vector<int> vertices_;
+    std::vector<int> offsets_;
+    std::vector<int> adjacents_;
+};
+
+} // namespace simulator
+} // namespace gossip
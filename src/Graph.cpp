@@ -1,4 +1,4 @@
-#include <chrono>
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <set>
@@ -14,7 +14,6 @@
 
 #include "Graph.h"
 
-using std::chrono::system_clock;
 using std::default_random_engine;
 using std::map;
 using std::set;
@@ -57,6 +56,14 @@ public:
     vector<vector<int>> compute();
 
 private:
+    // Depth-first traversals are iterative, as recursion would overflow the
+    // stack on large graphs.
+    struct Frame {
+        int vertex;
+        vector<int> adjacents;
+        size_t next{ 0 };
+    };
+
     void visit_(int vertex, map<int, bool>& visited, stack<int>& vertices);
     void assign_(int vertex,
                  int root,
@@ -104,11 +111,24 @@ void Kosaraju::visit_(int vertex, map<int, bool>& visited, stack<int>& vertices)
 
     visited[vertex] = true;
 
-    for (int adjacent : g_.adjacents(vertex)) {
-        visit_(adjacent, visited, vertices);
-    }
+    stack<Frame> frames;
+    frames.push({ vertex, g_.adjacents(vertex) | to<vector> });
 
-    vertices.push(vertex);
+    while (!frames.empty()) {
+        Frame& frame = frames.top();
+
+        if (frame.next == frame.adjacents.size()) {
+            vertices.push(frame.vertex);
+            frames.pop();
+            continue;
+        }
+
+        int adjacent = frame.adjacents[frame.next++];
+        if (!visited[adjacent]) {
+            visited[adjacent] = true;
+            frames.push({ adjacent, g_.adjacents(adjacent) | to<vector> });
+        }
+    }
 }
 
 void Kosaraju::assign_(int vertex,
@@ -116,23 +136,31 @@ void Kosaraju::assign_(int vertex,
                        map<int, bool>& visited,
                        map<int, vector<int>>& components)
 {
-    if (visited[vertex]) {
-        return;
-    }
+    stack<int> pending;
+    pending.push(vertex);
 
-    visited[vertex] = true;
-    components[root].push_back(vertex);
+    while (!pending.empty()) {
+        int cur = pending.top();
+        pending.pop();
+
+        if (visited[cur]) {
+            continue;
+        }
 
-    for (int adjacent : t_.adjacents(vertex)) {
-        assign_(adjacent, root, visited, components);
+        visited[cur] = true;
+        components[root].push_back(cur);
+
+        for (int adjacent : t_.adjacents(cur)) {
+            pending.push(adjacent);
+        }
     }
 }
 
 } // namespace
 
-Graph::Graph(int numVertices, int numAdjacents, bool makeConnected)
+Graph::Graph(int numVertices, int numAdjacents, unsigned seed, bool makeConnected)
 {
-    default_random_engine rand(system_clock::now().time_since_epoch().count());
+    default_random_engine rand(seed);
 
     for (int cur = 1; cur <= numVertices; ++cur) {
         int vertex = cur;
@@ -148,6 +176,8 @@ Graph::Graph(int numVertices, int numAdjacents, bool makeConnected)
     if (makeConnected) {
         makeConnected_();
     }
+
+    predecessors_ = std::move(transpose_().graph_);
 }
 
 Graph::Graph(map<int, vector<int>> graph) :
@@ -168,6 +198,72 @@ any_view<int> Graph::adjacents(int vertex) const
     return views::empty<int>;
 }
 
+int Graph::numEdges() const
+{
+    int num = 0;
+
+    for (const auto& entry : graph_) {
+        num += entry.second.size();
+    }
+
+    return num;
+}
+
+vector<int> Graph::addVertex(int vertex, vector<int> adjacents)
+{
+    graph_[vertex];
+
+    for (int adjacent : adjacents) {
+        addEdge_(vertex, adjacent);
+    }
+
+    if (adjacents.empty() || !addEdge_(adjacents.front(), vertex)) {
+        return {};
+    }
+
+    return { adjacents.front() };
+}
+
+vector<int> Graph::removeVertex(int vertex)
+{
+    auto pos = graph_.find(vertex);
+    if (pos == graph_.end()) {
+        return {};
+    }
+
+    vector<int> successors = std::move(pos->second);
+    vector<int> predecessors = std::move(predecessors_[vertex]);
+    graph_.erase(pos);
+    predecessors_.erase(vertex);
+
+    auto erase = [vertex](vector<int>& vertices) {
+        vertices.erase(std::remove(vertices.begin(), vertices.end(), vertex), vertices.end());
+    };
+
+    for (int successor : successors) {
+        erase(predecessors_[successor]);
+    }
+
+    set<int> changed;
+
+    for (int predecessor : predecessors) {
+        erase(graph_[predecessor]);
+        changed.insert(predecessor);
+
+        if (!successors.empty() && predecessor != successors.front()) {
+            addEdge_(predecessor, successors.front());
+        }
+    }
+
+    for (size_t i = 1; !predecessors.empty() && i < successors.size(); ++i) {
+        if (addEdge_(successors[i-1], successors[i])) {
+            changed.insert(successors[i-1]);
+        }
+    }
+
+    return { changed.begin(), changed.end() };
+}
+
 void Graph::makeConnected_()
 {
     Graph t = transpose_();
@@ -191,6 +287,18 @@ void Graph::makeConnected_()
     }
 }
 
+bool Graph::addEdge_(int from, int to)
+{
+    vector<int>& adjacents = graph_[from];
+    if (std::find(adjacents.begin(), adjacents.end(), to) != adjacents.end()) {
+        return false;
+    }
+
+    adjacents.push_back(to);
+    predecessors_[to].push_back(from);
+    return true;
+}
+
 Graph Graph::transpose_() const
 {
     map<int, vector<int>> transposed;
@@ -12,18 +12,33 @@ class Graph final {
 public:
     Graph(int numVertices,
           int numAdjacents,
+          unsigned seed,
           bool makeConnected = true);
 
     ranges::any_view<int> vertices() const;
     ranges::any_view<int> adjacents(int vertex) const;
+    int numEdges() const;
+
+    // Adds a new vertex with edges to the given adjacents, and an edge back
+    // from the first of them, which keeps a strongly connected graph strongly
+    // connected. Returns the vertices whose adjacents changed.
+    std::vector<int> addVertex(int vertex, std::vector<int> adjacents);
+
+    // Removes a vertex, and keeps the remaining vertices reachable from each
+    // other without recomputing components: its predecessors get an edge to
+    // its first successor, and its successors are linked in a chain. Returns
+    // the vertices whose adjacents changed.
+    std::vector<int> removeVertex(int vertex);
 
 private:
     explicit Graph(std::map<int, std::vector<int>> graph);
 
     void makeConnected_();
     Graph transpose_() const;
+    bool addEdge_(int from, int to);
 
     std::map<int, std::vector<int>> graph_;
+    std::map<int, std::vector<int>> predecessors_;
 };
 
 } // namespace simulator
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include "Graph.h"
+#include "GraphAnalysis.h"
+
+using std::atomic;
+using std::map;
+using std::optional;
+using std::string;
+using std::thread;
+using std::uniform_int_distribution;
+using std::unordered_set;
+using std::vector;
+
+namespace gossip {
+namespace simulator {
+
+namespace {
+
+// Expands bottom-up once the frontier's edges times this factor exceed the
+// edges into unvisited vertices, i.e. once they're more than 1/14 of them.
+constexpr int64_t bottomUpFactor{ 14 };
+// Sampling repeatedly starts from the farthest vertices found so far, which
+// quickly approaches the diameter.
+constexpr int numSweeps{ 4 };
+constexpr int batchesPerSweep{ 4 };
+
+void printDegrees(const string& name, const map<int, int>& degrees)
+{
+    for (const auto& [degree, num] : degrees) {
+        std::cout << name << " " << degree << ": " << num << std::endl;
+    }
+}
+
+string toString(int distance)
+{
+    return distance < 0 ? "infinite" : std::to_string(distance);
+}
+
+} // namespace
+
+GraphAnalysis::GraphAnalysis(const Graph& g, unsigned seed) :
+    g_(g),
+    t_(g_.transpose()),
+    rand_(seed)
+{}
+
+GraphStats GraphAnalysis::run(optional<int> source)
+{
+    GraphStats stats;
+    stats.numVertices = g_.numVertices();
+    stats.numEdges = g_.numEdges();
+    stats.source = source;
+
+    optional<int> sourceIndex;
+    if (source) {
+        int index = g_.index(*source);
+        if (index < g_.numVertices() && g_.vertex(index) == *source) {
+            sourceIndex = index;
+        }
+    }
+
+    for (int index = 0; index < g_.numVertices(); ++index) {
+        ++stats.outDegrees[g_.degree(index)];
+        ++stats.inDegrees[t_.degree(index)];
+    }
+
+    vector<Batch> batches;
+
+    if (g_.numVertices() <= maxExactVertices) {
+        for (int first = 0; first < g_.numVertices(); first += numLanes) {
+            Batch batch;
+            for (int index = first; index < std::min(first + numLanes, g_.numVertices()); ++index) {
+                batch.sources.push_back(index);
+            }
+            batches.push_back(std::move(batch));
+        }
+
+        searchAll_(batches);
+        stats.exactDiameter = true;
+    } else {
+        batches = sample_(sourceIndex);
+    }
+
+    for (const Batch& batch : batches) {
+        for (size_t lane = 0; lane < batch.sources.size(); ++lane) {
+            int eccentricity = batch.eccentricities[lane];
+
+            if (stats.diameter >= 0) {
+                stats.diameter = eccentricity < 0 ? -1 : std::max(stats.diameter, eccentricity);
+            }
+            if (batch.sources[lane] == sourceIndex) {
+                stats.eccentricity = eccentricity;
+            }
+            ++stats.numSources;
+        }
+    }
+
+    return stats;
+}
+
+vector<GraphAnalysis::Batch> GraphAnalysis::sample_(optional<int> source)
+{
+    uniform_int_distribution<int> randomIndex(0, g_.numVertices() - 1);
+    unordered_set<int> searched;
+    vector<Batch> result;
+    vector<int> candidates;
+    if (source) {
+        candidates.push_back(*source);
+    }
+
+    for (int sweep = 0; sweep < numSweeps; ++sweep) {
+        vector<Batch> batches(batchesPerSweep);
+
+        for (Batch& batch : batches) {
+            while (static_cast<int>(batch.sources.size()) < numLanes) {
+                int index;
+                if (!candidates.empty()) {
+                    index = candidates.back();
+                    candidates.pop_back();
+                } else {
+                    index = randomIndex(rand_);
+                }
+
+                if (searched.insert(index).second) {
+                    batch.sources.push_back(index);
+                }
+            }
+        }
+
+        searchAll_(batches);
+
+        for (Batch& batch : batches) {
+            candidates.insert(candidates.end(), batch.farthest.begin(), batch.farthest.end());
+            result.push_back(std::move(batch));
+        }
+    }
+
+    return result;
+}
+
+void GraphAnalysis::searchAll_(vector<Batch>& batches) const
+{
+    size_t numThreads = std::min<size_t>(batches.size(),
+                                         std::max(1u, thread::hardware_concurrency()));
+    atomic<size_t> next{ 0 };
+
+    auto work = [this, &batches, &next] {
+        for (size_t i = next++; i < batches.size(); i = next++) {
+            search_(batches[i]);
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+
+    for (thread& t : threads) {
+        t.join();
+    }
+}
+
+void GraphAnalysis::search_(Batch& batch) const
+{
+    int numSources = batch.sources.size();
+    uint64_t all = numSources == numLanes ? ~uint64_t{ 0 } : (uint64_t{ 1 } << numSources) - 1;
+
+    vector<uint64_t> visited(g_.numVertices());
+    vector<uint64_t> frontier(g_.numVertices());
+    vector<uint64_t> next(g_.numVertices());
+
+    batch.eccentricities.assign(numSources, 0);
+    batch.farthest = batch.sources;
+
+    int64_t frontierEdges = 0;
+    int64_t unvisitedEdges = g_.numEdges();
+
+    for (int lane = 0; lane < numSources; ++lane) {
+        visited[batch.sources[lane]] |= uint64_t{ 1 } << lane;
+        frontier[batch.sources[lane]] |= uint64_t{ 1 } << lane;
+        frontierEdges += g_.degree(batch.sources[lane]);
+    }
+
+    for (int level = 1; ; ++level) {
+        if (frontierEdges * bottomUpFactor > unvisitedEdges) {
+            for (int index = 0; index < g_.numVertices(); ++index) {
+                uint64_t missing = all & ~visited[index];
+                if (!missing) {
+                    continue;
+                }
+
+                uint64_t found = 0;
+                const int* predecessors = t_.adjacents(index);
+                for (int i = 0; i < t_.degree(index) && (found & missing) != missing; ++i) {
+                    found |= frontier[predecessors[i]];
+                }
+                next[index] = found;
+            }
+        } else {
+            for (int index = 0; index < g_.numVertices(); ++index) {
+                if (!frontier[index]) {
+                    continue;
+                }
+
+                const int* adjacents = g_.adjacents(index);
+                for (int i = 0; i < g_.degree(index); ++i) {
+                    next[adjacents[i]] |= frontier[index];
+                }
+            }
+        }
+
+        frontierEdges = 0;
+        unvisitedEdges = 0;
+
+        for (int index = 0; index < g_.numVertices(); ++index) {
+            uint64_t reached = next[index] & ~visited[index];
+            next[index] = 0;
+            frontier[index] = reached;
+            visited[index] |= reached;
+
+            if (reached) {
+                frontierEdges += g_.degree(index);
+            }
+            if (visited[index] != all) {
+                unvisitedEdges += t_.degree(index);
+            }
+
+            for (; reached; reached &= reached - 1) {
+                int lane = __builtin_ctzll(reached);
+                batch.eccentricities[lane] = level;
+                batch.farthest[lane] = index;
+            }
+        }
+
+        if (frontierEdges == 0) {
+            break;
+        }
+    }
+
+    uint64_t reachedAll = all;
+    for (uint64_t lanes : visited) {
+        reachedAll &= lanes;
+    }
+
+    for (int lane = 0; lane < numSources; ++lane) {
+        if (!(reachedAll & (uint64_t{ 1 } << lane))) {
+            batch.eccentricities[lane] = -1;
+        }
+    }
+}
+
+void printGraphStats(const GraphStats& stats, int fanout, optional<int> observedRounds)
+{
+    std::cout << "---" << std::endl;
+    std::cout << "Graph: " << stats.numVertices << " vertices, " << stats.numEdges <<
+        " edges" << std::endl;
+    printDegrees("Out-degree", stats.outDegrees);
+    printDegrees("In-degree", stats.inDegrees);
+
+    std::cout << "Diameter: ";
+    if (stats.exactDiameter || stats.diameter < 0) {
+        std::cout << toString(stats.diameter) << std::endl;
+    } else {
+        std::cout << ">= " << stats.diameter << " (sampled from " << stats.numSources <<
+            " vertices)" << std::endl;
+    }
+
+    if (!stats.source) {
+        std::cout << "Origin unknown, no lower bound on rounds" << std::endl;
+        return;
+    }
+
+    std::cout << "Eccentricity of node " << *stats.source << ": ";
+    if (!stats.eccentricity) {
+        std::cout << "unknown, the node departed" << std::endl;
+        return;
+    }
+    std::cout << toString(*stats.eccentricity) << std::endl;
+
+    if (*stats.eccentricity < 0) {
+        return;
+    }
+
+    int fanoutRounds = 0;
+    for (int64_t informed = 1; informed < stats.numVertices; informed *= fanout + 1) {
+        ++fanoutRounds;
+    }
+
+    int lowerBound = std::max(*stats.eccentricity, fanoutRounds);
+    std::cout << "Lower bound on rounds: " << lowerBound << " (hops: " <<
+        *stats.eccentricity << ", fanout: " << fanoutRounds << ")" << std::endl;
+
+    if (observedRounds && lowerBound > 0) {
+        std::cout << "Observed rounds: " << *observedRounds << " (" <<
+            static_cast<double>(*observedRounds) / lowerBound << "x the lower bound)" <<
+            std::endl;
+    }
+}
+
+} // namespace simulator
+} // namespace gossip
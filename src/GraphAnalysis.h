@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "CompactGraph.h"
+
+namespace gossip {
+namespace simulator {
+
+class Graph;
+
+struct GraphStats {
+    int numVertices{ 0 };
+    int numEdges{ 0 };
+    // Exact if all vertices were searched from, a lower bound otherwise.
+    int diameter{ 0 };
+    bool exactDiameter{ false };
+    int numSources{ 0 };
+    std::optional<int> source;
+    // Of the source vertex; -1 if it doesn't reach all vertices, unknown if
+    // there's no source or it isn't part of the graph, e.g. as it departed.
+    std::optional<int> eccentricity;
+    // Degree -> number of vertices
+    std::map<int, int> outDegrees;
+    std::map<int, int> inDegrees;
+};
+
+// Hop distances in the graph, found by breadth-first searches from numLanes
+// sources at once: each bit of a vertex' state belongs to one source. Each
+// level is either expanded top-down from the frontier, or bottom-up by
+// checking the predecessors of unvisited vertices, whichever touches fewer
+// edges. Batches of sources are searched in parallel.
+class GraphAnalysis final {
+public:
+    static constexpr int numLanes{ 64 };
+    static constexpr int maxExactVertices{ 1 << 14 };
+
+    GraphAnalysis(const Graph& g, unsigned seed);
+
+    // Searches from all vertices for graphs up to maxExactVertices, and from
+    // a sample otherwise, which always includes the source if it's present.
+    GraphStats run(std::optional<int> source);
+
+private:
+    struct Batch {
+        std::vector<int> sources;
+        std::vector<int> eccentricities;
+        std::vector<int> farthest;
+    };
+
+    void search_(Batch& batch) const;
+    void searchAll_(std::vector<Batch>& batches) const;
+    std::vector<Batch> sample_(std::optional<int> source);
+
+    CompactGraph g_;
+    CompactGraph t_;
+    std::default_random_engine rand_;
+};
+
+// Prints the graph's stats and the lower bound on rounds until all vertices
+// received a message from the source: it takes at least as many rounds as
+// hops, and the number of informed nodes grows at most by a factor of
+// fanout + 1 per round.
+void printGraphStats(const GraphStats& stats, int fanout, std::optional<int> observedRounds);
+
+} // namespace simulator
+} // namespace gossip
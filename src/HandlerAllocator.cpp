@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <new>
+
+#include "HandlerAllocator.h"
+
+namespace gossip {
+namespace simulator {
+
+namespace {
+
+constexpr size_t blockBytes[]{ 64, 128, 256, 512, 1024 };
+constexpr int numSizeClasses{ sizeof(blockBytes) / sizeof(blockBytes[0]) };
+constexpr size_t chunkBytes{ 64 * 1024 };
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// Trivially destructible, so the slab stays usable while other thread-local
+// and static objects are destroyed.
+struct Slab {
+    FreeBlock* free[numSizeClasses];
+    size_t numBlocks[numSizeClasses];
+    size_t numReserved;
+    char* chunk;
+    size_t chunkLeft;
+};
+
+thread_local Slab slab{};
+
+// Returns -1 for sizes which are passed on to the heap.
+int sizeClass(size_t size)
+{
+    for (int i = 0; i < numSizeClasses; ++i) {
+        if (size <= blockBytes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void carve(int i, size_t num)
+{
+    char* blocks = static_cast<char*>(::operator new(num * blockBytes[i]));
+
+    for (size_t n = 0; n < num; ++n) {
+        auto block = reinterpret_cast<FreeBlock*>(blocks + n * blockBytes[i]);
+        block->next = slab.free[i];
+        slab.free[i] = block;
+    }
+    slab.numBlocks[i] += num;
+}
+
+} // namespace
+
+void* HandlerSlab::allocate(size_t size)
+{
+    int i = sizeClass(size);
+    if (i < 0) {
+        return ::operator new(size);
+    }
+
+    if (slab.numBlocks[i] < slab.numReserved) {
+        carve(i, slab.numReserved - slab.numBlocks[i]);
+    }
+
+    if (FreeBlock* block = slab.free[i]) {
+        slab.free[i] = block->next;
+        return block;
+    }
+
+    // The rest of the previous chunk is smaller than a block and dropped.
+    if (slab.chunkLeft < blockBytes[i]) {
+        slab.chunk = static_cast<char*>(::operator new(chunkBytes));
+        slab.chunkLeft = chunkBytes;
+    }
+
+    void* ptr = slab.chunk;
+    slab.chunk += blockBytes[i];
+    slab.chunkLeft -= blockBytes[i];
+    ++slab.numBlocks[i];
+    return ptr;
+}
+
+void HandlerSlab::deallocate(void* ptr, size_t size)
+{
+    int i = sizeClass(size);
+    if (i < 0) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    auto block = static_cast<FreeBlock*>(ptr);
+    block->next = slab.free[i];
+    slab.free[i] = block;
+}
+
+void HandlerSlab::reserve(size_t num)
+{
+    slab.numReserved += num;
+}
+
+void HandlerSlab::release(size_t num)
+{
+    slab.numReserved -= std::min(num, slab.numReserved);
+}
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+
+namespace gossip {
+namespace simulator {
+
+// Per-thread memory for the operations of asynchronous handlers. Freed blocks
+// are kept in free lists per size class, so once the number of pending
+// operations peaked, starting an operation doesn't touch the heap anymore.
+// Memory is never returned, and a block must be freed on the thread which
+// allocated it (each io_context runs on a single thread).
+class HandlerSlab final {
+public:
+    static void* allocate(std::size_t size);
+    static void deallocate(void* ptr, std::size_t size);
+
+    // Makes room for num more pending operations of each size used on this
+    // thread. The next operation of each size carves the missing blocks at
+    // once, so a later peak can't make the slab grow mid-run.
+    static void reserve(std::size_t num);
+    static void release(std::size_t num);
+};
+
+// Allocator to associate with handlers via boost::asio::bind_allocator.
+template <typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    HandlerAllocator() = default;
+
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t num)
+    {
+        return static_cast<T*>(HandlerSlab::allocate(num * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t num)
+    {
+        HandlerSlab::deallocate(ptr, num * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const HandlerAllocator<U>&) const noexcept
+    {
+        return false;
+    }
+};
+
+} // namespace simulator
+} // namespace gossip
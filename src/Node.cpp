@@ -1,51 +1,76 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <utility>
 
+#include <boost/asio/bind_allocator.hpp>
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
 #include <boost/asio/ip/address_v6.hpp>
 #include <boost/system/error_code.hpp>
 
-#include <range/v3/action/shuffle.hpp>
-#include <range/v3/action/take.hpp>
-#include <range/v3/range/conversion.hpp>
-#include <range/v3/view/cache1.hpp>
-#include <range/v3/view/join.hpp>
-#include <range/v3/view/transform.hpp>
-
+#include "HandlerAllocator.h"
 #include "Node.h"
 
 using std::chrono::milliseconds;
 using std::chrono::system_clock;
 using std::make_shared;
 using std::shared_ptr;
+using std::ostream;
 using std::string;
+using std::string_view;
 using std::vector;
 
+using boost::asio::bind_allocator;
 using boost::asio::buffer;
 using boost::asio::io_context;
 using boost::asio::ip::address_v6;
 using boost::asio::ip::udp;
 using boost::system::error_code;
 
-using ranges::to;
-
-namespace actions = ranges::actions;
-namespace views = ranges::views;
-
 namespace gossip {
 namespace simulator {
 
 namespace {
 
-constexpr size_t maxReceiveBytes{ 1024 };
+constexpr uint32_t fragmentMagic{ 0x47535046 }; // "GSPF"
+
+struct Header {
+    uint32_t magic;
+    uint32_t payloadBytes;
+    uint32_t index;
+};
+
+static_assert(sizeof(Header) == Node::headerBytes, "header must not be padded");
 
-string toString(const vector<uint16_t>& nums)
+// A receive, the round timer and one send.
+constexpr size_t maxPendingOperations{ 3 };
+
+size_t numFragments(size_t payloadBytes)
 {
-    string s = nums | views::transform([](uint16_t num) {
-        return std::to_string(num);
-    }) | views::cache1 | views::join(" ") | to<string>;
+    return (payloadBytes + Node::fragmentBytes - 1) / Node::fragmentBytes;
+}
+
+// Handler memory is recycled instead of allocated per operation.
+template <typename Handler>
+auto pooled(Handler&& handler)
+{
+    return bind_allocator(HandlerAllocator<void>(), std::forward<Handler>(handler));
+}
 
-    return "[ " + s + " ]";
+// Streams the ports directly, so printing a fanout doesn't build strings.
+struct Ports {
+    const vector<uint16_t>& ports;
+};
+
+ostream& operator<<(ostream& out, const Ports& p)
+{
+    out << "[ ";
+    for (uint16_t port : p.ports) {
+        out << port << " ";
+    }
+    return out << "]";
 }
 
 } // namespace
@@ -53,32 +78,48 @@ string toString(const vector<uint16_t>& nums)
 Node::Node(io_context& io,
            uint16_t udpPort,
            vector<uint16_t> neighbors,
+           const vector<double>& weights,
            milliseconds period,
            int fanout,
+           unsigned seed,
            Tag) :
     socket_(io, udp::endpoint(udp::v6(), udpPort)),
+    port_(socket_.local_endpoint().port()),
     timer_(io),
-    neighbors_(std::move(neighbors)),
+    selector_(std::move(neighbors), weights),
     period_(std::move(period)),
     fanout_(fanout),
-    rand_(system_clock::now().time_since_epoch().count())
+    rand_(seed)
 {
-    buf_.resize(maxReceiveBytes);
-    std::cout << port() << " started, neighbors=" << toString(neighbors_) <<
+    // One byte more than any valid datagram, so truncation can be detected.
+    buf_.resize(maxDatagramBytes + 1);
+    datagram_.resize(maxDatagramBytes);
+    selected_.reserve(fanout_);
+    HandlerSlab::reserve(maxPendingOperations);
+    std::cout << port() << " started, neighbors=" << Ports{ selector_.peers() } <<
         ", period=" << period_.count() << "ms, fanout=" << fanout_ << std::endl;
 }
 
+Node::~Node()
+{
+    HandlerSlab::release(maxPendingOperations);
+}
+
 shared_ptr<Node> Node::create(io_context& io,
                               uint16_t udpPort,
                               vector<uint16_t> neighbors,
+                              const vector<double>& weights,
                               milliseconds period,
-                              int fanout)
+                              int fanout,
+                              unsigned seed)
 {
     auto node = make_shared<Node>(io,
                                   udpPort,
                                   std::move(neighbors),
+                                  weights,
                                   std::move(period),
                                   fanout,
+                                  seed,
                                   Tag{});
     node->start_();
     return node;
@@ -86,12 +127,12 @@ shared_ptr<Node> Node::create(io_context& io,
 
 uint16_t Node::port() const
 {
-    return socket_.local_endpoint().port();
+    return port_;
 }
 
 const vector<uint16_t>& Node::neighbors() const
 {
-    return neighbors_;
+    return selector_.peers();
 }
 
 const Node::Stats& Node::stats() const
@@ -99,6 +140,67 @@ const Node::Stats& Node::stats() const
     return stats_;
 }
 
+bool Node::hasPayload() const
+{
+    return numHeld_ > 0;
+}
+
+bool Node::complete() const
+{
+    return numHeld_ > 0 && numHeld_ == held_.size();
+}
+
+void Node::inject(string_view payload)
+{
+    for (size_t index = 0; index < numFragments(payload.size()); ++index) {
+        store_(payload.size(), index, payload.substr(index * fragmentBytes, fragmentBytes));
+    }
+}
+
+void Node::deliver(string_view datagram)
+{
+    ++stats_.numReceived;
+
+    if (datagram.size() > maxDatagramBytes) {
+        std::cerr << port() << " dropped datagram exceeding " << maxDatagramBytes <<
+            " bytes" << std::endl;
+        return;
+    }
+
+    Header header{};
+    if (datagram.size() >= sizeof(header)) {
+        std::memcpy(&header, datagram.data(), sizeof(header));
+    }
+
+    if (header.magic != fragmentMagic) {
+        // E.g. sent by util/inject_message.py
+        if (!hasPayload()) {
+            inject(datagram);
+        }
+        return;
+    }
+
+    datagram.remove_prefix(sizeof(header));
+    store_(header.payloadBytes, header.index, datagram);
+}
+
+void Node::setForwarder(Forwarder forward)
+{
+    forward_ = std::move(forward);
+}
+
+void Node::setNeighbors(vector<uint16_t> neighbors, const vector<double>& weights)
+{
+    selector_ = PeerSelector(std::move(neighbors), weights);
+}
+
+void Node::stop()
+{
+    error_code err;
+    timer_.cancel();
+    socket_.close(err);
+}
+
 void Node::start_()
 {
     receive_();
@@ -110,27 +212,30 @@ void Node::receive_()
     socket_.async_receive_from(
         buffer(buf_),
         peer_,
-        [this, keep=shared_from_this()](const error_code& err, size_t num) {
-        if (err) {
-            std::cerr << port() << " async_receive_from: " << err.message() << std::endl;
+        pooled([this](const error_code& err, size_t num) {
+        if (err == boost::asio::error::operation_aborted) {
             return;
         }
 
-        if (msg_.empty()) {
-            stats_.firstReceived = system_clock::now();
+        if (err) {
+            std::cerr << port() << " async_receive_from: " << err.message() << std::endl;
+            return;
         }
-        ++stats_.numReceived;
 
-        msg_ = buf_.substr(0, num);
+        deliver(string_view(buf_.data(), num));
         receive_();
-    });
+    }));
 }
 
 void Node::sendLoop_()
 {
     timer_.expires_after(period_);
     timer_.async_wait(
-        [this, keep=shared_from_this()](const error_code& err) {
+        pooled([this](const error_code& err) {
+        if (err == boost::asio::error::operation_aborted) {
+            return;
+        }
+
         if (err) {
             std::cerr << port() << " async_wait: " << err.message() << std::endl;
             return;
@@ -138,48 +243,118 @@ void Node::sendLoop_()
 
         prepareSend_();
         sendLoop_();
-    });
+    }));
 }
 
 void Node::prepareSend_()
 {
-    if (msg_.empty()) {
+    // A node still sending the previous round is limited by bandwidth, and
+    // skips this one.
+    if (!hasPayload() || sending_) {
         return;
     }
 
-    vector<uint16_t> neighbors = neighbors_;
-    neighbors |= actions::shuffle(rand_) | actions::take(fanout_);
-    std::cout << port() << " fanout to " << toString(neighbors) << std::endl;
-    sendNext_(std::move(neighbors));
+    selector_.select(fanout_, rand_, selected_);
+    numPending_ = selected_.size();
+    nextFragment_ = 0;
+    std::cout << port() << " fanout to " << Ports{ selected_ } << std::endl;
+    sendNext_();
     ++stats_.numSent;
 }
 
-void Node::sendNext_(vector<uint16_t> neighbors)
+// Sends each fragment held to each selected neighbor, one datagram at a time.
+void Node::sendNext_()
 {
-    if (neighbors.empty()) {
+    while (numPending_ > 0) {
+        while (nextFragment_ < held_.size() && !held_[nextFragment_]) {
+            ++nextFragment_;
+        }
+
+        if (nextFragment_ == held_.size()) {
+            --numPending_;
+            nextFragment_ = 0;
+            continue;
+        }
+
+        uint16_t neighbor = selected_[numPending_ - 1];
+        size_t size = makeDatagram_(nextFragment_++);
+
+        if (forward_ && forward_(neighbor, string_view(datagram_.data(), size))) {
+            stats_.bytesSent += size;
+            continue;
+        }
+
+        sending_ = true;
+
+        socket_.async_send_to(
+            buffer(datagram_.data(), size),
+            udp::endpoint(address_v6::loopback(), neighbor),
+            pooled([this, neighbor](const error_code& err, size_t num) {
+            if (err == boost::asio::error::operation_aborted) {
+                return;
+            }
+
+            if (err) {
+                std::cerr << port() << " async_send_to(" << neighbor << "): " <<
+                    err.message() << std::endl;
+                sending_ = false;
+                return;
+            }
+
+            stats_.bytesSent += num;
+            sendNext_();
+        }));
         return;
     }
 
-    uint16_t neighbor = neighbors.back();
-    neighbors.pop_back();
+    sending_ = false;
+}
 
-    socket_.async_send_to(
-        buffer(msg_),
-        udp::endpoint(address_v6::loopback(), neighbor),
-        [this,
-         keep=shared_from_this(),
-         neighbor,
-         neighbors=std::move(neighbors)](const error_code& err, size_t num) {
-        if (err) {
-            std::cerr << port() << " async_send_to(" << neighbor << "): " <<
-                err.message() << std::endl;
-            return;
-        }
+// Returns false for fragments which are invalid, duplicates, or belong to
+// another payload than the one being disseminated.
+bool Node::store_(size_t payloadBytes, size_t index, string_view fragment)
+{
+    size_t offset = index * fragmentBytes;
+    if (payloadBytes == 0 ||
+        payloadBytes > maxPayloadBytes ||
+        index >= numFragments(payloadBytes) ||
+        fragment.size() != std::min(fragmentBytes, payloadBytes - offset)) {
+        return false;
+    }
+
+    if (!hasPayload()) {
+        payload_.assign(payloadBytes, '\0');
+        held_.assign(numFragments(payloadBytes), false);
+        stats_.payloadBytes = static_cast<int>(payloadBytes);
+        stats_.firstReceived = system_clock::now();
+    } else if (payloadBytes != payload_.size() || held_[index]) {
+        return false;
+    }
 
-        sendNext_(std::move(neighbors));
-    });
+    fragment.copy(&payload_[offset], fragment.size());
+    held_[index] = true;
+
+    if (++numHeld_ == held_.size()) {
+        stats_.completed = system_clock::now();
+    }
+    return true;
+}
+
+size_t Node::makeDatagram_(size_t index)
+{
+    size_t offset = index * fragmentBytes;
+    size_t size = std::min(fragmentBytes, payload_.size() - offset);
+
+    Header header{
+        fragmentMagic,
+        static_cast<uint32_t>(payload_.size()),
+        static_cast<uint32_t>(index)
+    };
+    std::memcpy(&datagram_[0], &header, sizeof(header));
+    payload_.copy(&datagram_[sizeof(header)], size, offset);
+
+    return sizeof(header) + size;
 }
 
 } // namespace simulator
 } // namespace gossip
-
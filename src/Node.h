@@ -1,61 +1,113 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <random>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <boost/asio/steady_timer.hpp>
 
+#include "PeerSelector.h"
+
 namespace gossip {
 namespace simulator {
 
-class Node final : public std::enable_shared_from_this<Node> {
+// Handlers of pending operations refer to the node without owning it, so a
+// node must be kept alive until its io_context is done with them.
+class Node final {
 private:
     struct Tag{};
 
 public:
+    // Payloads are split into fragments, each sent as a datagram with a
+    // header, so nodes forward fragments before they have the whole payload.
+    static constexpr size_t maxDatagramBytes{ 1024 };
+    static constexpr size_t headerBytes{ 12 };
+    static constexpr size_t fragmentBytes{ maxDatagramBytes - headerBytes };
+    static constexpr size_t maxPayloadBytes{ 16 * 1024 * 1024 };
+
+    // Called with each datagram to send; returns false if the datagram should
+    // be sent over the node's socket instead.
+    using Forwarder = std::function<bool(uint16_t port, std::string_view datagram)>;
+
     struct Stats {
         std::chrono::time_point<std::chrono::system_clock> firstReceived;
+        std::chrono::time_point<std::chrono::system_clock> completed;
+        // Datagrams, so each fragment of a payload and each duplicate counts.
         int numReceived{ 0 };
         int numSent{ 0 };
+        int64_t bytesSent{ 0 };
+        int payloadBytes{ 0 };
     };
 
     Node(boost::asio::io_context& io,
          uint16_t udpPort,
          std::vector<uint16_t> neighbors,
+         const std::vector<double>& weights,
          std::chrono::milliseconds period,
          int fanout,
+         unsigned seed,
          Tag);
+    ~Node();
 
     static std::shared_ptr<Node> create(boost::asio::io_context& io,
                                         uint16_t udpPort,
                                         std::vector<uint16_t> neighbors,
+                                        const std::vector<double>& weights,
                                         std::chrono::milliseconds period,
-                                        int fanout);
+                                        int fanout,
+                                        unsigned seed);
 
     uint16_t port() const;
     const std::vector<uint16_t>& neighbors() const;
     const Stats& stats() const;
+    bool hasPayload() const;
+    bool complete() const;
+
+    // Starts disseminating a payload which originates at this node.
+    void inject(std::string_view payload);
+    // Handles a datagram as if it was received over the node's socket. Any
+    // datagram which isn't a fragment is taken as a payload of its own, unless
+    // it's longer than maxDatagramBytes.
+    void deliver(std::string_view datagram);
+    void setForwarder(Forwarder forward);
+    void setNeighbors(std::vector<uint16_t> neighbors, const std::vector<double>& weights);
+    void stop();
 
 private:
     void start_();
     void receive_();
     void sendLoop_();
     void prepareSend_();
-    void sendNext_(std::vector<uint16_t> neighbors);
+    void sendNext_();
+    bool store_(size_t payloadBytes, size_t index, std::string_view fragment);
+    size_t makeDatagram_(size_t index);
 
     boost::asio::ip::udp::socket socket_;
+    uint16_t port_;
     boost::asio::ip::udp::endpoint peer_;
     boost::asio::steady_timer timer_;
     std::string buf_;
-    std::string msg_;
-    std::vector<uint16_t> neighbors_;
+    std::string payload_;
+    std::vector<bool> held_;
+    size_t numHeld_{ 0 };
+    std::string datagram_;
+    PeerSelector selector_;
+    std::vector<uint16_t> selected_;
+    size_t numPending_{ 0 };
+    size_t nextFragment_{ 0 };
+    bool sending_{ false };
     std::chrono::milliseconds period_{ 5000 };
     int fanout_{ 1 };
     std::default_random_engine rand_;
+    Forwarder forward_;
     Stats stats_;
 };
 
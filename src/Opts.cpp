@@ -1,9 +1,11 @@
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <utility>
 
 #include <boost/program_options.hpp>
 
+#include "Node.h"
 #include "Opts.h"
 
 using std::chrono::seconds;
@@ -24,6 +26,17 @@ optional<Opts> Opts::parse(int argc, char *argv[], int maxNodes)
     int periodSec;
     int fanout;
     string outfile;
+    unsigned seed;
+    int inject;
+    int trials;
+    int numZones;
+    double zoneWeight;
+    double joinRate;
+    double leaveRate;
+    double crashRate;
+    int stallRounds;
+    int numWorkers;
+    int payloadBytes;
 
     po::options_description desc("Allowed options");
     desc.add_options()
@@ -36,10 +49,48 @@ optional<Opts> Opts::parse(int argc, char *argv[], int maxNodes)
         ("fanout", po::value<int>(&fanout)->default_value(1), "fanout per round of gossip")
         ("json-out",
          po::value<string>(&outfile),
-         "path to write results as Json");
+         "path to write results as Json")
+        ("seed", po::value<unsigned>(&seed), "seed for graph and neighbor selection")
+        ("inject",
+         po::value<int>(&inject),
+         "inject a message into the given node (1-based) on startup")
+        ("trials",
+         po::value<int>(&trials),
+         "estimate rounds to full coverage over this many round-based trials instead of "
+         "running nodes")
+        ("zones",
+         po::value<int>(&numZones)->default_value(1),
+         "number of zones nodes are assigned to round-robin")
+        ("zone-weight",
+         po::value<double>(&zoneWeight)->default_value(1),
+         "weight of neighbors in the same zone when selecting the fanout")
+        ("join-rate",
+         po::value<double>(&joinRate)->default_value(0),
+         "nodes joining per second during gossip")
+        ("leave-rate",
+         po::value<double>(&leaveRate)->default_value(0),
+         "nodes leaving gracefully per second during gossip")
+        ("crash-rate",
+         po::value<double>(&crashRate)->default_value(0),
+         "nodes crashing per second during gossip")
+        ("stall-rounds",
+         po::value<int>(&stallRounds)->default_value(10),
+         "with churn, stop once no node received the message for this many periods (0: "
+         "only stop at full coverage)")
+        ("workers",
+         po::value<int>(&numWorkers)->default_value(1),
+         "number of processes to partition nodes across")
+        ("payload-bytes",
+         po::value<int>(&payloadBytes)->default_value(0),
+         "size of the injected payload, split into datagram-sized fragments (default: a "
+         "short text message)")
+        ("analyze",
+         "print diameter, eccentricity of the injected node, degree distribution and a lower "
+         "bound on rounds of the graph");
+
+    po::variables_map vm;
 
     try {
-        po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, desc), vm);
 
         if (vm.count("help")) {
@@ -54,6 +105,11 @@ optional<Opts> Opts::parse(int argc, char *argv[], int maxNodes)
         return nullopt;
     }
 
+    // Trials don't bind ports, so the number of nodes isn't bound by them.
+    if (vm.count("trials")) {
+        maxNodes = std::numeric_limits<int>::max();
+    }
+
     if (numNodes <= 0 || numNodes > maxNodes) {
         std::cerr << "Number of nodes must be between 1 and " << maxNodes << std::endl;
         return nullopt;
@@ -70,16 +126,78 @@ optional<Opts> Opts::parse(int argc, char *argv[], int maxNodes)
         return nullopt;
     }
 
+    if (vm.count("inject") && (inject <= 0 || inject > numNodes)) {
+        std::cerr << "Injected node must be between 1 and number of nodes" << std::endl;
+        return nullopt;
+    }
+
+    if (vm.count("trials") && trials <= 0) {
+        std::cerr << "Number of trials must be positive" << std::endl;
+        return nullopt;
+    }
+
+    if (numZones <= 0 || zoneWeight <= 0) {
+        std::cerr << "Number of zones and zone weight must be positive" << std::endl;
+        return nullopt;
+    }
+
+    if (joinRate < 0 || leaveRate < 0 || crashRate < 0) {
+        std::cerr << "Churn rates must not be negative" << std::endl;
+        return nullopt;
+    }
+
+    if (stallRounds < 0) {
+        std::cerr << "Stall rounds must not be negative" << std::endl;
+        return nullopt;
+    }
+
+    if (numWorkers <= 0 || numWorkers > numNodes) {
+        std::cerr << "Number of workers must be between 1 and number of nodes" << std::endl;
+        return nullopt;
+    }
+
+    if (numWorkers > 1 && joinRate + leaveRate + crashRate > 0) {
+        std::cerr << "Churn isn't supported with multiple workers" << std::endl;
+        return nullopt;
+    }
+
+    if (payloadBytes < 0 || payloadBytes > static_cast<int>(Node::maxPayloadBytes)) {
+        std::cerr << "Payload size must be between 0 and " << Node::maxPayloadBytes <<
+            " bytes" << std::endl;
+        return nullopt;
+    }
+
     Opts opts;
     opts.numNodes = numNodes;
     opts.numNeighbors = numNeighbors;
     opts.period = seconds(periodSec);
     opts.fanout = fanout;
+    opts.numZones = numZones;
+    opts.zoneWeight = zoneWeight;
+    opts.joinRate = joinRate;
+    opts.leaveRate = leaveRate;
+    opts.crashRate = crashRate;
+    opts.stallRounds = stallRounds;
+    opts.numWorkers = numWorkers;
+    opts.payloadBytes = payloadBytes;
+    opts.analyze = vm.count("analyze") > 0;
 
     if (!outfile.empty()) {
         opts.outfile = std::move(outfile);
     }
 
+    if (vm.count("seed")) {
+        opts.seed = seed;
+    }
+
+    if (vm.count("inject")) {
+        opts.inject = inject;
+    }
+
+    if (vm.count("trials")) {
+        opts.trials = trials;
+    }
+
     return opts;
 }
 
@@ -12,9 +12,21 @@ struct Opts {
 
     int numNodes;
     int numNeighbors;
-    std::chrono::seconds period;
+    std::chrono::milliseconds period;
     int fanout;
     std::optional<std::string> outfile;
+    std::optional<unsigned> seed;
+    std::optional<int> inject;
+    std::optional<int> trials;
+    int numZones;
+    double zoneWeight;
+    double joinRate;
+    double leaveRate;
+    double crashRate;
+    int stallRounds;
+    int numWorkers;
+    int payloadBytes;
+    bool analyze;
 };
 
 } // namespace simulator
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <numeric>
+
+#include "PeerSelector.h"
+
+using std::default_random_engine;
+using std::uniform_real_distribution;
+using std::vector;
+
+namespace gossip {
+namespace simulator {
+
+namespace {
+
+// Duplicates are rejected when drawing weighted peers; give up after this many
+// draws per peer and pick the rest uniformly among the peers not chosen yet,
+// which only happens if a few peers hold almost all the weight.
+constexpr int maxDrawsPerPeer{ 16 };
+
+} // namespace
+
+PeerSelector::PeerSelector(vector<uint16_t> peers, const vector<double>& weights) :
+    peers_(std::move(peers)),
+    scratch_(peers_)
+{
+    if (weights.empty() || weights.size() != peers_.size()) {
+        return;
+    }
+
+    // Vose's alias method
+    int num = peers_.size();
+    double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    vector<double> scaled(num);
+    vector<int> small;
+    vector<int> large;
+
+    for (int i = 0; i < num; ++i) {
+        scaled[i] = weights[i] * num / sum;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+
+    prob_.assign(num, 1);
+    alias_.resize(num);
+    std::iota(alias_.begin(), alias_.end(), 0);
+
+    while (!small.empty() && !large.empty()) {
+        int less = small.back();
+        small.pop_back();
+        int more = large.back();
+
+        prob_[less] = scaled[less];
+        alias_[less] = more;
+
+        scaled[more] += scaled[less] - 1;
+        if (scaled[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    chosen_.assign(num, false);
+    picked_.reserve(num);
+    order_.resize(num);
+    std::iota(order_.begin(), order_.end(), 0);
+}
+
+const vector<uint16_t>& PeerSelector::peers() const
+{
+    return peers_;
+}
+
+void PeerSelector::select(int num, default_random_engine& rand, vector<uint16_t>& selected)
+{
+    selected.clear();
+    num = std::min<int>(num, peers_.size());
+
+    if (prob_.empty()) {
+        selectUniform_(num, rand, selected);
+    } else {
+        selectWeighted_(num, rand, selected);
+    }
+}
+
+void PeerSelector::selectUniform_(int num,
+                                  default_random_engine& rand,
+                                  vector<uint16_t>& selected)
+{
+    int size = scratch_.size();
+
+    for (int i = 0; i < num; ++i) {
+        int j = i + rand() % (size - i);
+        std::swap(scratch_[i], scratch_[j]);
+        selected.push_back(scratch_[i]);
+    }
+}
+
+void PeerSelector::selectWeighted_(int num,
+                                   default_random_engine& rand,
+                                   vector<uint16_t>& selected)
+{
+    int size = peers_.size();
+    size_t numPicks = num;
+    uniform_real_distribution<double> coin(0, 1);
+
+    for (int draws = 0; picked_.size() < numPicks && draws < num * maxDrawsPerPeer; ++draws) {
+        int column = rand() % size;
+        int index = coin(rand) < prob_[column] ? column : alias_[column];
+
+        if (!chosen_[index]) {
+            chosen_[index] = true;
+            picked_.push_back(index);
+        }
+    }
+
+    // Partial Fisher-Yates shuffle of all indices, skipping chosen ones, so
+    // each remaining peer is equally likely.
+    for (int i = 0; picked_.size() < numPicks; ++i) {
+        int j = i + rand() % (size - i);
+        std::swap(order_[i], order_[j]);
+
+        int index = order_[i];
+        if (!chosen_[index]) {
+            chosen_[index] = true;
+            picked_.push_back(index);
+        }
+    }
+
+    for (int index : picked_) {
+        chosen_[index] = false;
+        selected.push_back(peers_[index]);
+    }
+    picked_.clear();
+}
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace gossip {
+namespace simulator {
+
+// Picks distinct random peers for a round of gossip in O(fanout) and without
+// allocating. Peers are uniformly chosen via a partial Fisher-Yates shuffle of
+// a scratch copy, or, if weights are given, drawn from an alias table.
+class PeerSelector final {
+public:
+    explicit PeerSelector(std::vector<uint16_t> peers,
+                          const std::vector<double>& weights = {});
+
+    const std::vector<uint16_t>& peers() const;
+
+    // Replaces the contents of selected, which keeps its capacity between rounds.
+    void select(int num, std::default_random_engine& rand, std::vector<uint16_t>& selected);
+
+private:
+    void selectUniform_(int num,
+                        std::default_random_engine& rand,
+                        std::vector<uint16_t>& selected);
+    void selectWeighted_(int num,
+                         std::default_random_engine& rand,
+                         std::vector<uint16_t>& selected);
+
+    std::vector<uint16_t> peers_;
+    std::vector<uint16_t> scratch_;
+    std::vector<double> prob_;
+    std::vector<int> alias_;
+    std::vector<bool> chosen_;
+    std::vector<int> picked_;
+    std::vector<int> order_;
+};
+
+} // namespace simulator
+} // namespace gossip
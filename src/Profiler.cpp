@@ -0,0 +1,82 @@
+#include <sys/resource.h>
+
+#include "Profiler.h"
+
+using std::atomic;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+using std::string;
+using std::vector;
+
+namespace gossip {
+namespace simulator {
+
+namespace {
+
+microseconds toMicroseconds(const timeval& tv)
+{
+    return seconds(tv.tv_sec) + microseconds(tv.tv_usec);
+}
+
+} // namespace
+
+atomic<uint64_t>& Profiler::allocations()
+{
+    static atomic<uint64_t> numAllocations{ 0 };
+    return numAllocations;
+}
+
+void Profiler::addEvents(uint64_t num)
+{
+    if (!phases_.empty()) {
+        phases_.back().numEvents += num;
+    }
+}
+
+const vector<Profiler::Phase>& Profiler::phases() const
+{
+    return phases_;
+}
+
+Profiler::Usage Profiler::usage_()
+{
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+
+    Usage usage;
+    usage.wallTime = steady_clock::now();
+    usage.cpuTime = toMicroseconds(ru.ru_utime) + toMicroseconds(ru.ru_stime);
+#ifdef __APPLE__
+    usage.peakRssKb = ru.ru_maxrss / 1024; // bytes on macOS
+#else
+    usage.peakRssKb = ru.ru_maxrss;
+#endif
+    usage.numAllocations = allocations().load(std::memory_order_relaxed);
+
+    return usage;
+}
+
+void Profiler::begin_(string name)
+{
+    Phase phase;
+    phase.name = std::move(name);
+
+    phases_.push_back(std::move(phase));
+    start_ = usage_();
+}
+
+void Profiler::end_()
+{
+    Usage end = usage_();
+    Phase& phase = phases_.back();
+
+    phase.wallTime = duration_cast<microseconds>(end.wallTime - start_.wallTime);
+    phase.cpuTime = end.cpuTime - start_.cpuTime;
+    phase.rssGrowthKb = end.peakRssKb - start_.peakRssKb;
+    phase.numAllocations = end.numAllocations - start_.numAllocations;
+}
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gossip {
+namespace simulator {
+
+class Profiler final {
+public:
+    struct Phase {
+        std::string name;
+        std::chrono::microseconds wallTime{ 0 };
+        std::chrono::microseconds cpuTime{ 0 };
+        // Growth of the process' peak RSS during the phase, so memory already
+        // used by earlier phases isn't attributed to it.
+        long rssGrowthKb{ 0 };
+        uint64_t numEvents{ 0 };
+        uint64_t numAllocations{ 0 };
+    };
+
+    // Heap allocations so far. Only counted by executables which replace the
+    // global operator new, see BenchMain.cpp; zero otherwise.
+    static std::atomic<uint64_t>& allocations();
+
+    template <typename F>
+    auto measure(std::string name, F&& f);
+
+    void addEvents(uint64_t num);
+
+    const std::vector<Phase>& phases() const;
+
+private:
+    struct Usage {
+        std::chrono::steady_clock::time_point wallTime;
+        std::chrono::microseconds cpuTime{ 0 };
+        long peakRssKb{ 0 };
+        uint64_t numAllocations{ 0 };
+    };
+
+    static Usage usage_();
+
+    void begin_(std::string name);
+    void end_();
+
+    std::vector<Phase> phases_;
+    Usage start_;
+};
+
+template <typename F>
+auto Profiler::measure(std::string name, F&& f)
+{
+    begin_(std::move(name));
+
+    if constexpr (std::is_void_v<std::invoke_result_t<F>>) {
+        f();
+        end_();
+    } else {
+        auto result = f();
+        end_();
+        return result;
+    }
+}
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <numeric>
+
+#include "Graph.h"
+#include "RoundEngine.h"
+
+using std::array;
+using std::map;
+using std::vector;
+
+namespace gossip {
+namespace simulator {
+
+namespace {
+
+// Fixed-size loops over the lane words, which the compiler turns into SIMD
+// instructions.
+template <size_t N>
+void orInto(array<uint64_t, N>& dst, const array<uint64_t, N>& src)
+{
+    for (size_t i = 0; i < N; ++i) {
+        dst[i] |= src[i];
+    }
+}
+
+template <size_t N>
+void andInto(array<uint64_t, N>& dst, const array<uint64_t, N>& src)
+{
+    for (size_t i = 0; i < N; ++i) {
+        dst[i] &= src[i];
+    }
+}
+
+template <size_t N>
+bool isEmpty(const array<uint64_t, N>& lanes)
+{
+    uint64_t any = 0;
+    for (size_t i = 0; i < N; ++i) {
+        any |= lanes[i];
+    }
+    return any == 0;
+}
+
+int percentile(const vector<int>& sorted, int p)
+{
+    return sorted[(sorted.size() - 1) * p / 100];
+}
+
+} // namespace
+
+RoundEngine::RoundEngine(const Graph& g, int fanout, unsigned seed) :
+    g_(g),
+    fanout_(fanout),
+    rand_{ seed },
+    infected_(g_.numVertices()),
+    next_(g_.numVertices())
+{
+    int maxDegree = 0;
+    for (int index = 0; index < g_.numVertices(); ++index) {
+        maxDegree = std::max(maxDegree, g_.degree(index));
+    }
+
+    selected_.resize(maxDegree);
+}
+
+vector<int> RoundEngine::run(int numTrials, int source, int maxRounds)
+{
+    vector<int> rounds;
+    rounds.reserve(numTrials);
+
+    for (int done = 0; done < numTrials; done += numLanes) {
+        runBatch_(std::min(numLanes, numTrials - done), g_.index(source), maxRounds, rounds);
+    }
+
+    return rounds;
+}
+
+void RoundEngine::runBatch_(int numTrials, int source, int maxRounds, vector<int>& rounds)
+{
+    Lanes active{};
+    for (int lane = 0; lane < numTrials; ++lane) {
+        active[lane / 64] |= uint64_t{ 1 } << (lane % 64);
+    }
+
+    std::fill(infected_.begin(), infected_.end(), Lanes{});
+    infected_[source] = active;
+
+    vector<int> result(numTrials, -1);
+    Lanes covered{};
+
+    for (int round = 0; ; ++round) {
+        Lanes full = active;
+        for (const Lanes& lanes : infected_) {
+            andInto(full, lanes);
+        }
+
+        for (int word = 0; word < numWords; ++word) {
+            for (uint64_t bits = full[word] & ~covered[word]; bits; bits &= bits - 1) {
+                result[word * 64 + __builtin_ctzll(bits)] = round;
+            }
+        }
+        covered = full;
+
+        if (covered == active || round == maxRounds) {
+            break;
+        }
+
+        next_ = infected_;
+        for (int index = 0; index < g_.numVertices(); ++index) {
+            pushFrom_(index);
+        }
+        std::swap(infected_, next_);
+    }
+
+    rounds.insert(rounds.end(), result.begin(), result.end());
+}
+
+uint64_t RoundEngine::Random::operator()()
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+void RoundEngine::pushFrom_(int index)
+{
+    const Lanes& state = infected_[index];
+    if (isEmpty(state)) {
+        return;
+    }
+
+    int degree = g_.degree(index);
+    const int* adjacents = g_.adjacents(index);
+
+    if (fanout_ >= degree) {
+        for (int i = 0; i < degree; ++i) {
+            orInto(next_[adjacents[i]], state);
+        }
+        return;
+    }
+
+    // Each trial picks its own neighbors via Floyd's sampling, collected as
+    // one lane mask per neighbor, so the pushes below are word-wide.
+    std::fill_n(selected_.begin(), degree, Lanes{});
+
+    for (int word = 0; word < numWords; ++word) {
+        for (uint64_t bits = state[word]; bits; bits &= bits - 1) {
+            uint64_t lane = bits & -bits;
+
+            for (int i = degree - fanout_; i < degree; ++i) {
+                int j = (rand_() >> 32) * (i + 1) >> 32;
+                if (selected_[j][word] & lane) {
+                    j = i;
+                }
+                selected_[j][word] |= lane;
+            }
+        }
+    }
+
+    for (int i = 0; i < degree; ++i) {
+        orInto(next_[adjacents[i]], selected_[i]);
+    }
+}
+
+void printRoundStats(const vector<int>& rounds)
+{
+    vector<int> covered;
+    std::copy_if(rounds.begin(), rounds.end(), std::back_inserter(covered), [](int round) {
+        return round >= 0;
+    });
+    std::sort(covered.begin(), covered.end());
+
+    std::cout << "Trials: " << rounds.size() << ", full coverage: " << covered.size() <<
+        std::endl;
+
+    if (covered.empty()) {
+        return;
+    }
+
+    double avg = std::accumulate(covered.begin(), covered.end(), 0.0) / covered.size();
+    double variance = 0;
+    for (int round : covered) {
+        variance += (round - avg) * (round - avg);
+    }
+    variance /= covered.size();
+
+    map<int, int> histogram;
+    for (int round : covered) {
+        ++histogram[round];
+    }
+
+    for (const auto& [round, num] : histogram) {
+        std::cout << round << " rounds: " << num << std::endl;
+    }
+
+    std::cout << "---" << std::endl;
+    std::cout << "Avg. rounds: " << avg << std::endl;
+    std::cout << "Std. dev. rounds: " << std::sqrt(variance) << std::endl;
+    std::cout << "Min. rounds: " << covered.front() << std::endl;
+    std::cout << "Max. rounds: " << covered.back() << std::endl;
+    std::cout << "p50/p90/p99 rounds: " << percentile(covered, 50) << "/" <<
+        percentile(covered, 90) << "/" << percentile(covered, 99) << std::endl;
+}
+
+} // namespace simulator
+} // namespace gossip
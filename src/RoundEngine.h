@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "CompactGraph.h"
+
+namespace gossip {
+namespace simulator {
+
+class Graph;
+
+// Round-synchronous model of the gossip protocol, used to estimate the
+// distribution of rounds until all nodes received the message. Each bit of a
+// vertex' state is an independent trial, so one sweep over the graph advances
+// numLanes trials at once.
+class RoundEngine final {
+public:
+    static constexpr int numWords{ 8 };
+    static constexpr int numLanes{ numWords * 64 };
+
+    RoundEngine(const Graph& g, int fanout, unsigned seed);
+
+    // Returns the number of rounds until full coverage per trial, or -1 for
+    // trials which didn't reach all vertices within maxRounds.
+    std::vector<int> run(int numTrials, int source, int maxRounds);
+
+private:
+    using Lanes = std::array<uint64_t, numWords>;
+
+    // Per-lane neighbor selection draws a random number per trial and
+    // fanout, so this uses SplitMix64 which is much cheaper than the engines
+    // in <random>.
+    struct Random {
+        uint64_t state;
+
+        uint64_t operator()();
+    };
+
+    void runBatch_(int numTrials, int source, int maxRounds, std::vector<int>& rounds);
+    void pushFrom_(int index);
+
+    CompactGraph g_;
+    int fanout_;
+    Random rand_;
+    std::vector<Lanes> infected_;
+    std::vector<Lanes> next_;
+    std::vector<Lanes> selected_;
+};
+
+void printRoundStats(const std::vector<int>& rounds);
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,77 @@
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <new>
+#include <system_error>
+
+#include "SharedExchange.h"
+
+using std::atomic;
+
+namespace gossip {
+namespace simulator {
+
+namespace {
+
+constexpr size_t cacheLine{ 64 };
+
+size_t align(size_t offset)
+{
+    return (offset + cacheLine - 1) / cacheLine * cacheLine;
+}
+
+} // namespace
+
+SharedExchange::SharedExchange(int numWorkers, int numVertices, size_t ringCapacity) :
+    numWorkers_(numWorkers),
+    statsOffset_(align(sizeof(atomic<int>))),
+    ringsOffset_(align(statsOffset_ + (numVertices + 1) * sizeof(Stats))),
+    ringBytes_(align(SpscRing::bytes(ringCapacity))),
+    size_(ringsOffset_ + numWorkers * numWorkers * ringBytes_)
+{
+    void* memory = mmap(nullptr,
+                        size_,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS,
+                        -1,
+                        0);
+    if (memory == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+
+    // Anonymous mappings are zero-filled, which is the initial state of all
+    // stats; only the counter and rings need to be constructed.
+    memory_ = static_cast<char*>(memory);
+    new (memory_) atomic<int>(0);
+
+    for (int from = 0; from < numWorkers_; ++from) {
+        for (int to = 0; to < numWorkers_; ++to) {
+            SpscRing::create(memory_ + ringsOffset_ + (from * numWorkers_ + to) * ringBytes_,
+                             ringCapacity);
+        }
+    }
+}
+
+SharedExchange::~SharedExchange()
+{
+    munmap(memory_, size_);
+}
+
+atomic<int>& SharedExchange::numDone()
+{
+    return *reinterpret_cast<atomic<int>*>(memory_);
+}
+
+SharedExchange::Stats& SharedExchange::stats(int vertex)
+{
+    return reinterpret_cast<Stats*>(memory_ + statsOffset_)[vertex];
+}
+
+SpscRing& SharedExchange::ring(int from, int to)
+{
+    return *reinterpret_cast<SpscRing*>(
+        memory_ + ringsOffset_ + (from * numWorkers_ + to) * ringBytes_);
+}
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "SpscRing.h"
+
+namespace gossip {
+namespace simulator {
+
+// Memory shared by the processes of a partitioned simulation: stats per
+// vertex, the number of workers done, and a ring per ordered pair of workers.
+// The mapping is anonymous, so it must be created before forking the workers.
+class SharedExchange final {
+public:
+    struct Stats {
+        int64_t firstReceived; // system_clock ticks since epoch
+        int64_t completed;
+        int64_t bytesSent;
+        int32_t numReceived;
+        int32_t numSent;
+        int32_t payloadBytes;
+    };
+
+    SharedExchange(int numWorkers, int numVertices, size_t ringCapacity);
+    ~SharedExchange();
+
+    SharedExchange(const SharedExchange&) = delete;
+    SharedExchange& operator=(const SharedExchange&) = delete;
+
+    std::atomic<int>& numDone();
+    Stats& stats(int vertex);
+    SpscRing& ring(int from, int to);
+
+private:
+    int numWorkers_;
+    size_t statsOffset_;
+    size_t ringsOffset_;
+    size_t ringBytes_;
+    size_t size_;
+    char* memory_;
+};
+
+} // namespace simulator
+} // namespace gossip
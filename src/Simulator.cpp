@@ -1,31 +1,62 @@
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
 
 #include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+#include <range/v3/algorithm/count_if.hpp>
 #include <range/v3/algorithm/max_element.hpp>
-#include <range/v3/algorithm/minmax_element.hpp>
 #include <range/v3/range/conversion.hpp>
+#include <range/v3/view/map.hpp>
 #include <range/v3/view/transform.hpp>
 
 #include <nlohmann/json.hpp>
 
 #include "Graph.h"
 #include "Node.h"
+#include "RoundEngine.h"
+#include "SharedExchange.h"
 #include "Simulator.h"
+#include "SpscRing.h"
 
+using std::chrono::duration;
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+using std::chrono::system_clock;
+using std::exception;
+using std::exponential_distribution;
+using std::make_shared;
 using std::ofstream;
 using std::ostream;
 using std::optional;
+using std::pair;
+using std::runtime_error;
 using std::shared_ptr;
 using std::string;
+using std::string_view;
+using std::system_error;
+using std::uniform_real_distribution;
 using std::vector;
 
+using boost::asio::io_context;
+using boost::asio::steady_timer;
+using boost::system::error_code;
+
 using ranges::all_of;
+using ranges::any_of;
 using ranges::max_element;
-using ranges::minmax_element;
 using ranges::to;
 
 namespace views = ranges::views;
@@ -37,6 +68,15 @@ namespace simulator {
 
 namespace {
 
+constexpr char injectedMessage[]{ "Hello, world!" };
+constexpr int maxTrialRounds{ 10000 };
+constexpr int failureDetectionRounds{ 3 };
+constexpr size_t ringCapacity{ 1024 };
+constexpr milliseconds pollInterval{ 1 };
+
+static_assert(Node::maxDatagramBytes <= SpscRing::maxMessageBytes,
+              "datagrams must fit into ring slots");
+
 uint16_t vertexToPort(int vertex, uint16_t firstPort)
 {
     return (vertex & 0xffff) + firstPort;
@@ -44,24 +84,82 @@ uint16_t vertexToPort(int vertex, uint16_t firstPort)
 
 int portToVertex(uint16_t port, uint16_t firstPort)
 {
-    return port - firstPort + 1;
+    return port - firstPort;
+}
+
+// Each consumer of randomness gets its own stream derived from the seed, so
+// e.g. churn doesn't replay the stream which built the graph.
+enum Stream : unsigned {
+    graphStream,
+    payloadStream,
+    churnStream,
+    trialStream,
+    analysisStream,
+    nodeStream
+};
+
+// Mixes the seed with a stream and an id within it, so streams for
+// consecutive ids aren't related as they would be for consecutive seeds.
+unsigned mixSeed(unsigned seed, Stream stream, unsigned id = 0)
+{
+    std::seed_seq seq{ seed, static_cast<unsigned>(stream), id };
+    unsigned result;
+    seq.generate(&result, &result + 1);
+    return result;
+}
+
+// Random bytes, so payloads don't compress, or the short text message if no
+// size is given.
+string makePayload(int numBytes, unsigned seed)
+{
+    if (numBytes == 0) {
+        return injectedMessage;
+    }
+
+    std::independent_bits_engine<std::default_random_engine, 8, unsigned> rand(seed);
+
+    string payload(numBytes, '\0');
+    std::generate(payload.begin(), payload.end(), [&rand] {
+        return static_cast<char>(rand());
+    });
+    return payload;
+}
+
+// Neighbors in the same zone as the vertex get zoneWeight, all others 1. No
+// weights are returned if all would be equal, so uniform selection is used.
+vector<double> zoneWeights(int vertex, const vector<int>& adjacents, const Opts& opts)
+{
+    if (opts.numZones <= 1 || opts.zoneWeight == 1) {
+        return {};
+    }
+
+    return adjacents | views::transform([&opts, zone=vertex % opts.numZones](int adjacent) {
+        return adjacent % opts.numZones == zone ? opts.zoneWeight : 1.0;
+    }) | to<vector>;
+}
+
+// Nodes which don't hold the whole payload have no latency, e.g. if the
+// message was lost under churn.
+bool informed(const Node::Stats& stats)
+{
+    return stats.completed != system_clock::time_point();
 }
 
 class JsonWriter {
 public:
-    JsonWriter(const vector<shared_ptr<Node>>& nodes,
+    JsonWriter(const vector<NodeResult>& nodes,
                int maxRounds,
                uint16_t firstPort);
 
     void write(ostream& out);
 
 private:
-    const vector<shared_ptr<Node>>& nodes_;
+    const vector<NodeResult>& nodes_;
     int maxRounds_;
     uint16_t firstPort_;
 };
 
-JsonWriter::JsonWriter(const vector<shared_ptr<Node>>& nodes,
+JsonWriter::JsonWriter(const vector<NodeResult>& nodes,
                        int maxRounds,
                        uint16_t firstPort) :
     nodes_(nodes),
@@ -79,15 +177,16 @@ void JsonWriter::write(ostream& out)
     };
 
     for (const auto& node : nodes_) {
-        string id = nodeId(node->port());
-        for (uint16_t neighbor : node->neighbors()) {
+        string id = nodeId(node.port);
+        for (uint16_t neighbor : node.neighbors) {
             links.push_back({
                 { "source", id },
                 { "target", nodeId(neighbor) }
             });
         }
 
-        int it = maxRounds_ - node->stats().numSent;
+        // Uninformed nodes never appear in any iteration.
+        int it = informed(node.stats) ? maxRounds_ - node.stats.numSent : -1;
         nodes.push_back({
             { "id", std::move(id) },
             { "iterations", it }
@@ -103,7 +202,11 @@ void JsonWriter::write(ostream& out)
 } // namespace
 
 Simulator::Simulator(Opts opts) :
-    opts_(std::move(opts))
+    opts_(std::move(opts)),
+    seed_(opts_.seed.value_or(system_clock::now().time_since_epoch().count())),
+    payload_(makePayload(opts_.payloadBytes, mixSeed(seed_, payloadStream))),
+    churnTimer_(io_),
+    rand_(mixSeed(seed_, churnStream))
 {
     std::cout << "Initializing simulator - #nodes=" << opts_.numNodes <<
         ", #neighbors=" << opts_.numNeighbors <<
@@ -111,76 +214,602 @@ Simulator::Simulator(Opts opts) :
         ", fanout=" << opts_.fanout << std::endl;
 }
 
-vector<shared_ptr<Node>> Simulator::run()
+vector<NodeResult> Simulator::run()
+{
+    graph_.emplace(profiler_.measure("graph", [this] {
+        return Graph(opts_.numNodes, opts_.numNeighbors, mixSeed(seed_, graphStream));
+    }));
+    profiler_.addEvents(graph_->numEdges());
+
+    if (opts_.numWorkers > 1) {
+        vector<NodeResult> results = runPartitioned_();
+        origin_ = findOrigin_(results);
+        return results;
+    }
+
+    profiler_.measure("startup", [this] {
+        for (int vertex : graph_->vertices()) {
+            nodes_.emplace(vertex, createNode_(vertex));
+            live_.push_back(vertex);
+        }
+    });
+    profiler_.addEvents(nodes_.size());
+    nextVertex_ = opts_.numNodes + 1;
+
+    bool churning = false;
+
+    profiler_.measure("dissemination", [this, &churning] {
+        if (opts_.inject) {
+            nodes_.at(*opts_.inject)->inject(payload_);
+        }
+
+        // If all nodes which received the message departed, give in-flight
+        // messages some time to arrive before considering the message lost.
+        optional<steady_clock::time_point> lostSince;
+
+        // Joining nodes may keep coverage from ever becoming complete, so with
+        // churn the run also stops once no node received the message for a while.
+        bool stalls = opts_.stallRounds > 0 &&
+            opts_.joinRate + opts_.leaveRate + opts_.crashRate > 0;
+        size_t numComplete = 0;
+        steady_clock::time_point progressed;
+
+        while (!allReceived_()) {
+            if (!churning && anyReceived_()) {
+                scheduleChurn_();
+                churning = true;
+                progressed = steady_clock::now();
+            }
+
+            if (churning && stalls) {
+                size_t num = numComplete_();
+                auto now = steady_clock::now();
+                if (num > numComplete) {
+                    progressed = now;
+                }
+                numComplete = num;
+
+                if (now - progressed > opts_.stallRounds * opts_.period) {
+                    std::cout << "No node received the message for " << opts_.stallRounds <<
+                        " rounds, stopping" << std::endl;
+                    break;
+                }
+            }
+
+            if (churning && !anyReceived_()) {
+                auto now = steady_clock::now();
+                if (!lostSince) {
+                    lostSince = now;
+                } else if (now - *lostSince > 2 * opts_.period) {
+                    std::cout << "Message lost, all nodes which received it departed" <<
+                        std::endl;
+                    break;
+                }
+            } else {
+                lostSince.reset();
+            }
+
+            // Run all handlers which are ready before checking progress again,
+            // so completions are handled, and new operations submitted, in batches.
+            size_t num = io_.run_one();
+            num += io_.poll();
+            profiler_.addEvents(num);
+        }
+
+        churnTimer_.cancel();
+    });
+
+    if (churning && opts_.joinRate + opts_.leaveRate + opts_.crashRate > 0) {
+        printChurn_();
+    }
+
+    auto results = nodes_ | views::values | views::transform([](const auto& node) {
+        return NodeResult{ node->port(), node->neighbors(), node->stats() };
+    }) | to<vector>;
+    origin_ = findOrigin_(results);
+    return results;
+}
+
+void Simulator::runSteadyState(int rounds)
+{
+    profiler_.measure("steady-state", [this, rounds] {
+        profiler_.addEvents(io_.run_for(rounds * opts_.period));
+    });
+}
+
+vector<int> Simulator::runTrials()
+{
+    graph_.emplace(profiler_.measure("graph", [this] {
+        return Graph(opts_.numNodes, opts_.numNeighbors, mixSeed(seed_, graphStream));
+    }));
+    profiler_.addEvents(graph_->numEdges());
+
+    origin_ = opts_.inject.value_or(1);
+
+    return profiler_.measure("rounds", [this] {
+        RoundEngine engine(*graph_, opts_.fanout, mixSeed(seed_, trialStream));
+        return engine.run(*opts_.trials, *origin_, maxTrialRounds);
+    });
+}
+
+GraphStats Simulator::analyze()
 {
-    Graph g(opts_.numNodes, opts_.numNeighbors);
+    GraphStats stats = profiler_.measure("analysis", [this] {
+        GraphAnalysis analysis(*graph_, mixSeed(seed_, analysisStream));
+        return analysis.run(origin_);
+    });
+    profiler_.addEvents(stats.numSources);
 
-    vector<shared_ptr<Node>> nodes =
-        g.vertices() | views::transform([this, &g](int vertex) {
-            auto adjacents =
-                g.adjacents(vertex) | views::transform([](int adjacent) {
-                    return vertexToPort(adjacent, firstPort);
-                });
+    // A crashed origin stays in the graph until its crash is detected.
+    bool departed = any_of(departed_, [this](const auto& node) {
+        return origin_ && node->port() == vertexToPort(*origin_, firstPort);
+    });
+    if (departed) {
+        stats.eccentricity.reset();
+    }
+
+    return stats;
+}
+
+vector<NodeResult> Simulator::departed() const
+{
+    return departed_ | views::transform([](const auto& node) {
+        return NodeResult{ node->port(), node->neighbors(), node->stats() };
+    }) | to<vector>;
+}
+
+Profiler& Simulator::profiler()
+{
+    return profiler_;
+}
 
-            return Node::create(io_,
-                                vertexToPort(vertex, firstPort),
-                                adjacents | to<vector>,
-                                opts_.period,
-                                opts_.fanout);
-        }) | to<vector>;
+// Nodes are split into contiguous blocks, each run by a forked worker process.
+// Messages between nodes of different workers go through shared memory rings
+// instead of sockets. Workers progress independently, and only stop once all
+// of them report their nodes received the message.
+vector<NodeResult> Simulator::runPartitioned_()
+{
+    SharedExchange exchange(opts_.numWorkers, opts_.numNodes, ringCapacity);
+    vector<pid_t> workers;
+
+    auto stopWorkers = [&workers] {
+        for (pid_t pid : workers) {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    };
+
+    profiler_.measure("dissemination", [this, &exchange, &workers, &stopWorkers] {
+        for (int worker = 0; worker < opts_.numWorkers; ++worker) {
+            io_.notify_fork(io_context::fork_prepare);
+            pid_t pid = fork();
+
+            if (pid == 0) {
+                io_.notify_fork(io_context::fork_child);
+
+                int status = 0;
+                try {
+                    runWorker_(worker, exchange);
+                } catch (const exception& e) {
+                    std::cerr << "Worker " << worker << ": " << e.what() << std::endl;
+                    status = 1;
+                }
+
+                std::cout.flush();
+                _exit(status);
+            }
+
+            io_.notify_fork(io_context::fork_parent);
+
+            if (pid < 0) {
+                int err = errno;
+                stopWorkers();
+                throw system_error(err, std::generic_category(), "fork");
+            }
+
+            workers.push_back(pid);
+        }
 
-    auto allDone = [&nodes]{
-        return all_of(nodes, [](const auto& node) {
-            return node->stats().numReceived > 0;
+        while (!workers.empty()) {
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, 0);
+            if (pid < 0 && errno == EINTR) {
+                continue;
+            }
+
+            workers.erase(std::remove(workers.begin(), workers.end(), pid), workers.end());
+
+            if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                stopWorkers();
+                throw runtime_error("worker process failed");
+            }
+        }
+    });
+
+    return graph_->vertices() | views::transform([this, &exchange](int vertex) {
+        const SharedExchange::Stats& shared = exchange.stats(vertex);
+
+        Node::Stats stats;
+        stats.firstReceived =
+            system_clock::time_point(system_clock::duration(shared.firstReceived));
+        stats.completed = system_clock::time_point(system_clock::duration(shared.completed));
+        stats.numReceived = shared.numReceived;
+        stats.numSent = shared.numSent;
+        stats.bytesSent = shared.bytesSent;
+        stats.payloadBytes = shared.payloadBytes;
+
+        auto ports = graph_->adjacents(vertex) | views::transform([](int adjacent) {
+            return vertexToPort(adjacent, firstPort);
         });
+
+        return NodeResult{ vertexToPort(vertex, firstPort), ports | to<vector>, stats };
+    }) | to<vector>;
+}
+
+void Simulator::runWorker_(int worker, SharedExchange& exchange)
+{
+    outbox_.resize(opts_.numWorkers);
+
+    auto forward = [this, worker, &exchange](uint16_t port, string_view datagram) {
+        int target = owner_(portToVertex(port, firstPort));
+        if (target == worker) {
+            return false;
+        }
+
+        // Keep the order of datagrams once the ring was full
+        if (!outbox_[target].empty() ||
+            !exchange.ring(worker, target).push(port, datagram.data(), datagram.size())) {
+            outbox_[target].emplace_back(port, datagram);
+        }
+        return true;
     };
 
-    while (!allDone()) {
-        io_.run_one();
+    for (int vertex : graph_->vertices()) {
+        if (owner_(vertex) == worker) {
+            shared_ptr<Node> node = createNode_(vertex);
+            node->setForwarder(forward);
+            nodes_.emplace(vertex, std::move(node));
+        }
+    }
+
+    if (opts_.inject && owner_(*opts_.inject) == worker) {
+        nodes_.at(*opts_.inject)->inject(payload_);
     }
 
-    return nodes;
+    bool done = false;
+    uint16_t port;
+    string datagram;
+
+    while (exchange.numDone().load() < opts_.numWorkers) {
+        io_.run_for(pollInterval);
+
+        for (int source = 0; source < opts_.numWorkers; ++source) {
+            if (source == worker) {
+                continue;
+            }
+
+            SpscRing& ring = exchange.ring(source, worker);
+            while (ring.pop(port, datagram)) {
+                nodes_.at(portToVertex(port, firstPort))->deliver(datagram);
+            }
+        }
+
+        for (int target = 0; target < opts_.numWorkers; ++target) {
+            auto& pending = outbox_[target];
+            while (!pending.empty() &&
+                   exchange.ring(worker, target).push(pending.front().first,
+                                                      pending.front().second.data(),
+                                                      pending.front().second.size())) {
+                pending.pop_front();
+            }
+        }
+
+        if (!done && allReceived_()) {
+            done = true;
+            ++exchange.numDone();
+        }
+    }
+
+    for (const auto& [vertex, node] : nodes_) {
+        SharedExchange::Stats& shared = exchange.stats(vertex);
+        shared.firstReceived = node->stats().firstReceived.time_since_epoch().count();
+        shared.completed = node->stats().completed.time_since_epoch().count();
+        shared.bytesSent = node->stats().bytesSent;
+        shared.numReceived = node->stats().numReceived;
+        shared.numSent = node->stats().numSent;
+        shared.payloadBytes = node->stats().payloadBytes;
+    }
 }
 
-void printStats(const vector<shared_ptr<Node>>& nodes,
-                const optional<string>& outfile)
+// The node which held the payload first, i.e. where it was injected, whether
+// by --inject or externally. Departed nodes are included, as the origin may
+// have left since.
+optional<int> Simulator::findOrigin_(const vector<NodeResult>& nodes) const
 {
-    auto stats = nodes | views::transform([](const auto& node) {
-        return node->stats();
+    optional<pair<system_clock::time_point, uint16_t>> first;
+
+    auto consider = [&first](uint16_t port, const Node::Stats& stats) {
+        if (stats.firstReceived == system_clock::time_point()) {
+            return;
+        }
+
+        pair<system_clock::time_point, uint16_t> candidate{ stats.firstReceived, port };
+        first = first ? std::min(*first, candidate) : candidate;
+    };
+
+    for (const auto& node : nodes) {
+        consider(node.port, node.stats);
+    }
+    for (const auto& node : departed_) {
+        consider(node->port(), node->stats());
+    }
+
+    if (!first) {
+        return std::nullopt;
+    }
+    return portToVertex(first->second, firstPort);
+}
+
+int Simulator::owner_(int vertex) const
+{
+    return static_cast<int64_t>(vertex - 1) * opts_.numWorkers / opts_.numNodes;
+}
+
+shared_ptr<Node> Simulator::createNode_(int vertex)
+{
+    vector<int> adjacents = graph_->adjacents(vertex) | to<vector>;
+    auto ports = adjacents | views::transform([](int adjacent) {
+        return vertexToPort(adjacent, firstPort);
     });
 
-    auto receiveTimes = stats | views::transform([](const auto& stat) {
-        return stat.firstReceived;
+    return Node::create(io_,
+                        vertexToPort(vertex, firstPort),
+                        ports | to<vector>,
+                        zoneWeights(vertex, adjacents, opts_),
+                        opts_.period,
+                        opts_.fanout,
+                        mixSeed(seed_, nodeStream, vertex));
+}
+
+void Simulator::updateNeighbors_(const vector<int>& vertices)
+{
+    for (int vertex : vertices) {
+        auto pos = nodes_.find(vertex);
+        if (pos == nodes_.end()) {
+            continue;
+        }
+
+        vector<int> adjacents = graph_->adjacents(vertex) | to<vector>;
+        auto ports = adjacents | views::transform([](int adjacent) {
+            return vertexToPort(adjacent, firstPort);
+        });
+
+        pos->second->setNeighbors(ports | to<vector>, zoneWeights(vertex, adjacents, opts_));
+    }
+}
+
+bool Simulator::allReceived_() const
+{
+    return all_of(nodes_ | views::values, [](const auto& node) {
+        return node->complete();
+    });
+}
+
+size_t Simulator::numComplete_() const
+{
+    return ranges::count_if(nodes_ | views::values, [](const auto& node) {
+        return node->complete();
+    });
+}
+
+bool Simulator::anyReceived_() const
+{
+    return any_of(nodes_ | views::values, [](const auto& node) {
+        return node->hasPayload();
+    });
+}
+
+void Simulator::scheduleChurn_()
+{
+    double rate = opts_.joinRate + opts_.leaveRate + opts_.crashRate;
+    if (rate <= 0) {
+        return;
+    }
+
+    // Churn events form a Poisson process, each event being a join, leave or
+    // crash in proportion to their rates.
+    duration<double> delay{ exponential_distribution<double>(rate)(rand_) };
+    churnTimer_.expires_after(duration_cast<steady_clock::duration>(delay));
+    churnTimer_.async_wait([this, rate](const error_code& err) {
+        if (err) {
+            return;
+        }
+
+        double event = uniform_real_distribution<double>(0, rate)(rand_);
+        if (event < opts_.joinRate) {
+            join_();
+        } else if (event < opts_.joinRate + opts_.leaveRate) {
+            leave_(false);
+        } else {
+            leave_(true);
+        }
+
+        scheduleChurn_();
+    });
+}
+
+void Simulator::join_()
+{
+    int vertex = nextVertex_;
+    if (vertex > maxNodes) {
+        return;
+    }
+    ++nextVertex_;
+
+    // Kept in the order drawn, as the first one links back to the new vertex.
+    vector<int> adjacents;
+    while (adjacents.size() < std::min<size_t>(opts_.numNeighbors, live_.size())) {
+        int adjacent = live_[rand_() % live_.size()];
+        if (std::find(adjacents.begin(), adjacents.end(), adjacent) == adjacents.end()) {
+            adjacents.push_back(adjacent);
+        }
+    }
+
+    vector<int> changed = graph_->addVertex(vertex, std::move(adjacents));
+
+    nodes_.emplace(vertex, createNode_(vertex));
+    live_.push_back(vertex);
+    updateNeighbors_(changed);
+    ++churn_.numJoined;
+}
+
+void Simulator::leave_(bool crash)
+{
+    if (live_.size() <= 1) {
+        return;
+    }
+
+    auto pos = live_.begin() + rand_() % live_.size();
+    int vertex = *pos;
+    live_.erase(pos);
+
+    shared_ptr<Node> node = std::move(nodes_.at(vertex));
+    nodes_.erase(vertex);
+    node->stop();
+
+    std::cout << node->port() << (crash ? " crashed" : " left") << std::endl;
+
+    if (!node->complete()) {
+        ++churn_.numUninformed;
+    }
+    departed_.push_back(std::move(node));
+
+    if (!crash) {
+        ++churn_.numLeft;
+        updateNeighbors_(graph_->removeVertex(vertex));
+        return;
+    }
+
+    // Neighbors only notice a crash after a few rounds without hearing from
+    // the node, and keep sending to it until then.
+    ++churn_.numCrashed;
+
+    auto detect = make_shared<steady_timer>(io_, failureDetectionRounds * opts_.period);
+    detect->async_wait([this, detect, vertex](const error_code& err) {
+        if (err) {
+            return;
+        }
+
+        updateNeighbors_(graph_->removeVertex(vertex));
+    });
+}
+
+void Simulator::printChurn_() const
+{
+    auto numResidue = nodes_.size() - numComplete_();
+
+    std::cout << "Churn: joined=" << churn_.numJoined <<
+        ", left=" << churn_.numLeft <<
+        ", crashed=" << churn_.numCrashed <<
+        ", departed before receiving=" << churn_.numUninformed << std::endl;
+    std::cout << "Residue: " << numResidue << " of " << nodes_.size() <<
+        " live nodes not reached (" <<
+        (nodes_.empty() ? 0.0 : 100.0 * numResidue / nodes_.size()) << "%)" << std::endl;
+}
+
+void printStats(const vector<NodeResult>& nodes,
+                const vector<NodeResult>& departed,
+                const optional<string>& outfile)
+{
+    auto stats = nodes | views::transform([](const auto& node) {
+        return node.stats;
     });
 
     auto numSent = stats | views::transform([](const auto& stat) {
         return stat.numSent;
     });
 
-    const auto [minTime, maxTime] = minmax_element(receiveTimes);
-    auto diff = duration_cast<milliseconds>(*maxTime - *minTime);
+    // Latency is until a node has the whole payload, which for payloads of a
+    // single fragment is when it first received it. It's measured from the
+    // first informed node, i.e. the origin, and nodes which weren't informed
+    // are left out.
+    optional<system_clock::time_point> minTime;
+    system_clock::time_point maxTime;
+    int numInformed = 0;
+
+    for (const auto& node : nodes) {
+        if (informed(node.stats)) {
+            minTime = std::min(minTime.value_or(node.stats.firstReceived),
+                               node.stats.firstReceived);
+            maxTime = std::max(maxTime, node.stats.completed);
+            ++numInformed;
+        }
+    }
+
+    milliseconds diff{ 0 };
     milliseconds avg{ 0 };
+    if (minTime) {
+        diff = duration_cast<milliseconds>(maxTime - *minTime);
+    }
 
     const auto maxRounds = max_element(numSent);
+    int64_t totalBytesSent = 0;
+    int64_t maxBytesSent = 0;
+    int64_t payloadBytes = 0;
+    int numDelivered = numInformed;
 
     for (const auto& node : nodes) {
-        const Node::Stats& stat = node->stats();
+        const Node::Stats& stat = node.stats;
+
+        totalBytesSent += stat.bytesSent;
+        maxBytesSent = std::max(maxBytesSent, stat.bytesSent);
+        payloadBytes = std::max<int64_t>(payloadBytes, stat.payloadBytes);
+
+        std::cout << node.port << ": latency=";
+        if (informed(stat)) {
+            auto diff = duration_cast<milliseconds>(stat.completed - *minTime);
+            avg += diff;
+            std::cout << diff.count() << "ms";
+        } else {
+            std::cout << "none";
+        }
+        std::cout << ", datagrams received=" << stat.numReceived << ", sent=" <<
+            stat.numSent << ", bytes sent=" << stat.bytesSent << std::endl;
+    }
 
-        auto diff = duration_cast<milliseconds>(stat.firstReceived - *minTime);
-        avg += diff;
+    // Departed nodes have no latency, but their traffic counts towards the
+    // bandwidth used.
+    for (const auto& node : departed) {
+        const Node::Stats& stat = node.stats;
 
-        std::cout << node->port() << ": latency=" <<
-            duration_cast<milliseconds>(diff).count() << "ms" <<
-            ", received=" << stat.numReceived << ", sent=" <<
-            stat.numSent << std::endl;
+        totalBytesSent += stat.bytesSent;
+        maxBytesSent = std::max(maxBytesSent, stat.bytesSent);
+        payloadBytes = std::max<int64_t>(payloadBytes, stat.payloadBytes);
+        if (informed(stat)) {
+            ++numDelivered;
+        }
     }
 
-    avg /= nodes.size();
-
     std::cout << "---" << std::endl;
-    std::cout << "Avg. latency: " << avg.count() << "ms" << std::endl;
-    std::cout << "Max. latency: " << diff.count() << "ms" << std::endl;
+    if (numInformed > 0) {
+        std::cout << "Avg. latency: " << (avg / numInformed).count() << "ms" << std::endl;
+        std::cout << "Max. latency: " << diff.count() << "ms" << std::endl;
+    }
     std::cout << "Rounds of gossip: " << *maxRounds << std::endl;
+    std::cout << "Payload: " << payloadBytes << " bytes in " <<
+        (payloadBytes + Node::fragmentBytes - 1) / Node::fragmentBytes << " fragments" <<
+        std::endl;
+    std::cout << "Bytes sent: " << totalBytesSent << ", max. per node: " << maxBytesSent <<
+        std::endl;
+
+    // Goodput counts each payload delivered to a node other than its origin
+    // once, however many copies of its fragments were sent.
+    int64_t delivered = payloadBytes * std::max(numDelivered - 1, 0);
+    if (diff.count() > 0 && delivered > 0) {
+        std::cout << "Goodput: " << delivered / 1024.0 / duration<double>(diff).count() <<
+            " KB/s, overhead: " << static_cast<double>(totalBytesSent) / delivered << "x" <<
+            std::endl;
+    }
 
     if (outfile) {
         ofstream out(*outfile);
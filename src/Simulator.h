@@ -1,18 +1,33 @@
 #pragma once
 
+#include <deque>
+#include <map>
 #include <memory>
 #include <optional>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include "Graph.h"
+#include "GraphAnalysis.h"
+#include "Node.h"
 #include "Opts.h"
+#include "Profiler.h"
 
 namespace gossip {
 namespace simulator {
 
-class Node;
+class SharedExchange;
+
+struct NodeResult {
+    uint16_t port;
+    std::vector<uint16_t> neighbors;
+    Node::Stats stats;
+};
 
 class Simulator {
 public:
@@ -22,14 +37,67 @@ public:
 
     explicit Simulator(Opts opts);
 
-    std::vector<std::shared_ptr<Node>> run();
+    std::vector<NodeResult> run();
+    // Keeps the nodes of the last run gossiping for the given number of
+    // periods, once all of them hold the payload.
+    void runSteadyState(int rounds);
+    std::vector<int> runTrials();
+    // Analyzes the graph of the last run, as of its end, from the node where
+    // the payload originated.
+    GraphStats analyze();
+    // Nodes which departed during the last run, as of their departure.
+    std::vector<NodeResult> departed() const;
+
+    Profiler& profiler();
 
 private:
+    struct ChurnStats {
+        int numJoined{ 0 };
+        int numLeft{ 0 };
+        int numCrashed{ 0 };
+        int numUninformed{ 0 };
+    };
+
+    std::vector<NodeResult> runPartitioned_();
+    void runWorker_(int worker, SharedExchange& exchange);
+    int owner_(int vertex) const;
+    std::optional<int> findOrigin_(const std::vector<NodeResult>& nodes) const;
+
+    std::shared_ptr<Node> createNode_(int vertex);
+    void updateNeighbors_(const std::vector<int>& vertices);
+    bool allReceived_() const;
+    bool anyReceived_() const;
+    size_t numComplete_() const;
+
+    void scheduleChurn_();
+    void join_();
+    void leave_(bool crash);
+    void printChurn_() const;
+
     Opts opts_;
+    unsigned seed_;
+    std::string payload_;
+    Profiler profiler_;
     boost::asio::io_context io_;
+    boost::asio::steady_timer churnTimer_;
+    // For churn only, see mixSeed()
+    std::default_random_engine rand_;
+    std::optional<Graph> graph_;
+    // Pending handlers refer to nodes, so departed nodes are kept as well, and
+    // all of them are destroyed before io_.
+    std::map<int, std::shared_ptr<Node>> nodes_;
+    std::vector<int> live_;
+    std::vector<std::shared_ptr<Node>> departed_;
+    int nextVertex_{ 0 };
+    ChurnStats churn_;
+    std::optional<int> origin_;
+    std::vector<std::deque<std::pair<uint16_t, std::string>>> outbox_;
 };
 
-void printStats(const std::vector<std::shared_ptr<Node>>& nodes,
+// Latencies are of the live nodes, while departed nodes count towards the
+// bandwidth used.
+void printStats(const std::vector<NodeResult>& nodes,
+                const std::vector<NodeResult>& departed,
                 const std::optional<std::string>& outfile);
 
 } // namespace simulator
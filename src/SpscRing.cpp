@@ -0,0 +1,73 @@
+#include <cstring>
+#include <new>
+
+#include "SpscRing.h"
+
+using std::string;
+
+namespace gossip {
+namespace simulator {
+
+size_t SpscRing::bytes(size_t capacity)
+{
+    return sizeof(SpscRing) + capacity * sizeof(Slot);
+}
+
+SpscRing* SpscRing::create(void* memory, size_t capacity)
+{
+    return new (memory) SpscRing(capacity);
+}
+
+SpscRing::SpscRing(size_t capacity) :
+    mask_(capacity - 1)
+{}
+
+bool SpscRing::push(uint16_t port, const char* data, size_t size)
+{
+    if (size > maxMessageBytes) {
+        return false;
+    }
+
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cachedHead_ > mask_) {
+        cachedHead_ = head_.load(std::memory_order_acquire);
+        if (tail - cachedHead_ > mask_) {
+            return false;
+        }
+    }
+
+    Slot& slot = slot_(tail);
+    slot.port = port;
+    slot.size = size;
+    std::memcpy(slot.data, data, size);
+
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool SpscRing::pop(uint16_t& port, string& data)
+{
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == cachedTail_) {
+        cachedTail_ = tail_.load(std::memory_order_acquire);
+        if (head == cachedTail_) {
+            return false;
+        }
+    }
+
+    const Slot& slot = slot_(head);
+    port = slot.port;
+    data.assign(slot.data, slot.size);
+
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+SpscRing::Slot& SpscRing::slot_(uint64_t pos)
+{
+    auto* slots = reinterpret_cast<Slot*>(reinterpret_cast<char*>(this) + sizeof(SpscRing));
+    return slots[pos & mask_];
+}
+
+} // namespace simulator
+} // namespace gossip
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace gossip {
+namespace simulator {
+
+// Lock-free single-producer/single-consumer queue of datagrams, placed in
+// memory shared between two processes. Slots follow the ring itself, so the
+// memory passed to create() needs to hold bytes(capacity), and capacity must
+// be a power of two.
+class SpscRing final {
+public:
+    static constexpr size_t maxMessageBytes{ 1024 };
+
+    static size_t bytes(size_t capacity);
+    static SpscRing* create(void* memory, size_t capacity);
+
+    bool push(uint16_t port, const char* data, size_t size);
+    bool pop(uint16_t& port, std::string& data);
+
+private:
+    struct Slot {
+        uint16_t port;
+        uint16_t size;
+        char data[maxMessageBytes];
+    };
+
+    explicit SpscRing(size_t capacity);
+
+    Slot& slot_(uint64_t pos);
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "ring indices must be usable across processes");
+
+    // Each side caches the other side's index, so it only touches the other
+    // cache line once the ring looks full or empty.
+    alignas(64) std::atomic<uint64_t> head_{ 0 };
+    uint64_t cachedTail_{ 0 };
+    alignas(64) std::atomic<uint64_t> tail_{ 0 };
+    uint64_t cachedHead_{ 0 };
+    alignas(64) uint64_t mask_;
+};
+
+} // namespace simulator
+} // namespace gossip
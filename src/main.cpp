@@ -1,16 +1,16 @@
-#include <memory>
+#include <algorithm>
 #include <optional>
 #include <vector>
 
-#include "Node.h"
 #include "Opts.h"
+#include "RoundEngine.h"
 #include "Simulator.h"
 
+using std::nullopt;
 using std::optional;
-using std::shared_ptr;
 using std::vector;
 
-using gossip::simulator::Node;
+using gossip::simulator::NodeResult;
 using gossip::simulator::Opts;
 using gossip::simulator::Simulator;
 
@@ -22,9 +22,30 @@ int main(int argc, char* argv[])
     }
 
     Simulator simulator(*opts);
-    vector<shared_ptr<Node>> nodes = simulator.run();
 
-    gossip::simulator::printStats(nodes, opts->outfile);
+    if (opts->trials) {
+        gossip::simulator::printRoundStats(simulator.runTrials());
+
+        if (opts->analyze) {
+            gossip::simulator::printGraphStats(simulator.analyze(), opts->fanout, nullopt);
+        }
+        return 0;
+    }
+
+    vector<NodeResult> nodes = simulator.run();
+
+    gossip::simulator::printStats(nodes, simulator.departed(), opts->outfile);
+
+    if (opts->analyze && !nodes.empty()) {
+        auto maxRounds = std::max_element(nodes.begin(), nodes.end(), [](const auto& lhs,
+                                                                         const auto& rhs) {
+            return lhs.stats.numSent < rhs.stats.numSent;
+        });
+
+        gossip::simulator::printGraphStats(simulator.analyze(),
+                                           opts->fanout,
+                                           maxRounds->stats.numSent);
+    }
     return 0;
 }
 